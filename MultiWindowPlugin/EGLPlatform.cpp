@@ -0,0 +1,164 @@
+#ifdef __linux__
+#include "GLPlatform.h"
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <algorithm>
+#include "SDL_syswm.h"
+
+// Used when Unity's context was created through EGL, and for headless runs on Mesa where windows have no native surface.
+class EGLPlatform : public GLPlatform
+{
+public:
+	EGLPlatform(EGLDisplay display, EGLContext unityContext, EGLConfig config)
+		: _display(display)
+		, _unityContext(unityContext)
+		, _config(config)
+		, _unityDrawSurface(EGL_NO_SURFACE)
+		, _unityReadSurface(EGL_NO_SURFACE)
+	{
+	}
+
+	const char* Name() const override
+	{
+		return "EGL";
+	}
+
+	PlatformDrawable CreateDrawable(SDL_Window* pWindow) override
+	{
+		SDL_SysWMinfo info;
+		SDL_VERSION(&info.version);
+		const bool hasWMInfo = SDL_GetWindowWMInfo(pWindow, &info) == SDL_TRUE;
+
+		EGLSurface surface;
+		if (hasWMInfo && info.subsystem == SDL_SYSWM_X11)
+		{
+			surface = eglCreateWindowSurface(_display, _config, EGLNativeWindowType(info.info.x11.window), nullptr);
+		}
+		else
+		{
+			// SDL's offscreen driver has no native window, present into a pbuffer of the window's initial size instead.
+			int width, height;
+			SDL_GetWindowSize(pWindow, &width, &height);
+			const EGLint attributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+			surface = eglCreatePbufferSurface(_display, _config, attributes);
+		}
+
+		return surface == EGL_NO_SURFACE ? nullptr : surface;
+	}
+
+	void DestroyDrawable(PlatformDrawable drawable) override
+	{
+		if (drawable != nullptr)
+		{
+			eglDestroySurface(_display, EGLSurface(drawable));
+		}
+	}
+
+	void BeginPresent() override
+	{
+		_unityDrawSurface = eglGetCurrentSurface(EGL_DRAW);
+		_unityReadSurface = eglGetCurrentSurface(EGL_READ);
+	}
+
+	bool MakeUnityContextCurrent(PlatformDrawable drawable) override
+	{
+		return eglMakeCurrent(_display, EGLSurface(drawable), EGLSurface(drawable), _unityContext) == EGL_TRUE;
+	}
+
+	void EndPresent() override
+	{
+		eglMakeCurrent(_display, _unityDrawSurface, _unityReadSurface, _unityContext);
+	}
+
+	PlatformContext CreateSharedContext(PlatformDrawable /*drawable*/, bool debug) override
+	{
+		GLint majorVersion, minorVersion;
+		glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+		glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+		const EGLint attributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION_KHR, majorVersion,
+			EGL_CONTEXT_MINOR_VERSION_KHR, minorVersion,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+			EGL_CONTEXT_FLAGS_KHR, debug ? EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR : 0,
+			EGL_NONE
+		};
+
+		const EGLContext context = eglCreateContext(_display, _config, _unityContext, attributes);
+		return context == EGL_NO_CONTEXT ? nullptr : context;
+	}
+
+	bool MakeCurrent(PlatformDrawable drawable, PlatformContext context) override
+	{
+		// The client API is per thread and defaults to OpenGL ES.
+		eglBindAPI(EGL_OPENGL_API);
+		return eglMakeCurrent(_display, EGLSurface(drawable), EGLSurface(drawable), EGLContext(context)) == EGL_TRUE;
+	}
+
+	void ReleaseCurrent() override
+	{
+		eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	}
+
+	void DestroyContext(PlatformContext context) override
+	{
+		eglDestroyContext(_display, EGLContext(context));
+	}
+
+	void SwapBuffers(PlatformDrawable drawable) override
+	{
+		eglSwapBuffers(_display, EGLSurface(drawable));
+	}
+
+	// EGL has no adaptive vsync, and clamps the interval to what the configuration supports.
+	int SetSwapInterval(PlatformDrawable /*drawable*/, int interval) override
+	{
+		EGLint minInterval = 1, maxInterval = 1;
+		eglGetConfigAttrib(_display, _config, EGL_MIN_SWAP_INTERVAL, &minInterval);
+		eglGetConfigAttrib(_display, _config, EGL_MAX_SWAP_INTERVAL, &maxInterval);
+
+		interval = std::min(std::max(interval < 0 ? 1 : interval, int(minInterval)), int(maxInterval));
+		return eglSwapInterval(_display, interval) == EGL_TRUE ? interval : 1;
+	}
+
+private:
+	const EGLDisplay _display;
+	const EGLContext _unityContext;
+	const EGLConfig _config;
+	EGLSurface _unityDrawSurface;
+	EGLSurface _unityReadSurface;
+};
+
+GLPlatform* CreateEGLPlatform()
+{
+	if (eglQueryAPI() != EGL_OPENGL_API)
+	{
+		return nullptr;
+	}
+
+	const EGLContext unityContext = eglGetCurrentContext();
+	const EGLDisplay display = eglGetCurrentDisplay();
+	if (unityContext == EGL_NO_CONTEXT || display == EGL_NO_DISPLAY)
+	{
+		return nullptr;
+	}
+
+	// Surfaces and shared contexts must use the same configuration as Unity's context.
+	EGLint configId;
+	if (eglQueryContext(display, unityContext, EGL_CONFIG_ID, &configId) != EGL_TRUE)
+	{
+		return nullptr;
+	}
+
+	const EGLint attributes[] = { EGL_CONFIG_ID, configId, EGL_NONE };
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (eglChooseConfig(display, attributes, &config, 1, &configCount) != EGL_TRUE || configCount == 0)
+	{
+		return nullptr;
+	}
+
+	return new EGLPlatform(display, unityContext, config);
+}
+#endif
@@ -0,0 +1,312 @@
+#include "EventPump.h"
+#include "Window.h"
+#include "Profiler.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+int GetX11ConnectionNumber(SDL_Window* pWindow);
+#endif
+
+EventRing::EventRing()
+	: _events()
+	, _read(0)
+	, _write(0)
+	, _dropped(0)
+{
+}
+
+void EventRing::Push(const QueuedEvent& event)
+{
+	const unsigned int write = _write.load(std::memory_order_relaxed);
+	const unsigned int used = write - _read.load(std::memory_order_acquire);
+	if (used == Capacity || (used >= Capacity / 4 * 3 && event.event.type == SDL_MOUSEMOTION))
+	{
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	_events[write % Capacity] = event;
+	_write.store(write + 1, std::memory_order_release);
+}
+
+bool EventRing::Pop(QueuedEvent& event)
+{
+	const unsigned int read = _read.load(std::memory_order_relaxed);
+	if (read == _write.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	event = _events[read % Capacity];
+	_read.store(read + 1, std::memory_order_release);
+	return true;
+}
+
+unsigned int EventRing::GetDropped() const
+{
+	return _dropped.load(std::memory_order_relaxed);
+}
+
+EventPump::EventPump()
+	: _stopping(false)
+#ifdef _WIN32
+	, _wakeEvent(CreateEvent(nullptr, FALSE, FALSE, nullptr))
+#else
+	, _wakeFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+	, _displayFd(-1)
+#endif
+{
+}
+
+EventPump::~EventPump()
+{
+	Stop();
+#ifdef _WIN32
+	CloseHandle(_wakeEvent);
+#else
+	close(_wakeFd);
+#endif
+}
+
+bool EventPump::Start()
+{
+	if (_thread.joinable())
+	{
+		return true;
+	}
+
+	_stopping = false;
+	_thread = std::thread(&EventPump::Run, this);
+
+	bool initialised = false;
+	Invoke([&initialised]
+	{
+		initialised = SDL_Init(SDL_INIT_VIDEO) >= 0;
+	});
+
+	if (!initialised)
+	{
+		Stop();
+		return false;
+	}
+
+	Invoke([this]
+	{
+		SDL_AddEventWatch(OnEventAdded, this);
+	});
+	return true;
+}
+
+void EventPump::Stop()
+{
+	if (!_thread.joinable())
+	{
+		return;
+	}
+
+	Post([this]
+	{
+		SDL_DelEventWatch(OnEventAdded, this);
+		_windows.clear();
+		// Only the reference Start took. A host process that initialised SDL itself keeps its windows.
+		SDL_QuitSubSystem(SDL_INIT_VIDEO);
+#ifndef _WIN32
+		_displayFd = -1;
+#endif
+	});
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	Wake();
+	_thread.join();
+}
+
+void EventPump::Invoke(const std::function<void()>& command)
+{
+	if (!_thread.joinable() || std::this_thread::get_id() == _thread.get_id())
+	{
+		command();
+		return;
+	}
+
+	bool done = false;
+	Post([this, &command, &done]
+	{
+		command();
+		std::lock_guard<std::mutex> lock(_mutex);
+		done = true;
+		_completed.notify_all();
+	});
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_completed.wait(lock, [&done] { return done; });
+}
+
+void EventPump::Post(std::function<void()> command)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_commands.push_back(std::move(command));
+	}
+	Wake();
+}
+
+void EventPump::Register(Window* pWindow)
+{
+	_windows[pWindow->ID] = pWindow;
+
+#ifndef _WIN32
+	// All of SDL's windows share one connection, Wait sleeps on it.
+	if (_displayFd < 0)
+	{
+		_displayFd = GetX11ConnectionNumber(SDL_GetWindowFromID(pWindow->ID));
+	}
+#endif
+}
+
+void EventPump::Unregister(Window* pWindow)
+{
+	_windows.erase(pWindow->ID);
+}
+
+void EventPump::Run()
+{
+	const UnityProfilerThreadId profilerThread = Profiler::RegisterThread("Event Pump");
+
+	while (!RunCommands())
+	{
+		if (SDL_WasInit(SDL_INIT_VIDEO) != 0)
+		{
+			SDL_Event event;
+			while (SDL_PollEvent(&event) != 0)
+			{
+				Route(event);
+			}
+		}
+
+		Wait();
+	}
+
+	Profiler::UnregisterThread(profilerThread);
+}
+
+// Returns true once Stop has been called, after running everything queued before it.
+bool EventPump::RunCommands()
+{
+	bool stopping;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_running.swap(_commands);
+		stopping = _stopping;
+	}
+
+	for (auto it = _running.begin(); it != _running.end(); ++it)
+	{
+		(*it)();
+	}
+	_running.clear();
+	return stopping;
+}
+
+void EventPump::Route(const SDL_Event& event)
+{
+	Uint32 windowId;
+	switch (event.type)
+	{
+	case SDL_WINDOWEVENT:
+		windowId = event.window.windowID;
+		break;
+	case SDL_MOUSEMOTION:
+		windowId = event.motion.windowID;
+		break;
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+		windowId = event.button.windowID;
+		break;
+	case SDL_MOUSEWHEEL:
+		windowId = event.wheel.windowID;
+		break;
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		windowId = event.key.windowID;
+		break;
+	default:
+		return;
+	}
+
+	Window* pWindow = Find(windowId);
+	if (pWindow == nullptr)
+	{
+		return;
+	}
+
+	QueuedEvent queued = QueuedEvent();
+	queued.event = event;
+	queued.received = std::chrono::steady_clock::now();
+	pWindow->QueueEvent(queued);
+}
+
+Window* EventPump::Find(Uint32 windowId) const
+{
+	const auto it = _windows.find(windowId);
+	return it != _windows.end() ? it->second : nullptr;
+}
+
+void EventPump::Wait()
+{
+#ifdef _WIN32
+	// Returns as soon as a window message arrives or Wake sets the event, which stays set until waited on.
+	const HANDLE wakeEvent = _wakeEvent;
+	MsgWaitForMultipleObjectsEx(1, &wakeEvent, 100, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+#else
+	// Sleeps until the X server sends something or Wake writes the eventfd. SDL has just drained Xlib's queue, so
+	// anything new arrives on the connection. Without an X11 connection, as under Wayland, only the timeout is left.
+	pollfd fds[2] = { { _wakeFd, POLLIN, 0 }, { _displayFd, POLLIN, 0 } };
+	if (poll(fds, _displayFd >= 0 ? 2 : 1, _displayFd >= 0 ? 100 : 10) > 0 && (fds[0].revents & POLLIN) != 0)
+	{
+		uint64_t count;
+		if (read(_wakeFd, &count, sizeof(count)) < 0)
+		{
+			// Nothing to reset, another wake already drained it.
+		}
+	}
+#endif
+}
+
+void EventPump::Wake()
+{
+#ifdef _WIN32
+	SetEvent(_wakeEvent);
+#else
+	const uint64_t count = 1;
+	if (write(_wakeFd, &count, sizeof(count)) < 0)
+	{
+		// The counter is already non-zero, the pump wakes anyway.
+	}
+#endif
+}
+
+// Raised on the pump thread as soon as SDL queues an event, which can be inside a modal move/size loop where the
+// queue is not being drained.
+int SDLCALL EventPump::OnEventAdded(void* pUserData, SDL_Event* pEvent)
+{
+	if (pEvent->type != SDL_WINDOWEVENT || (pEvent->window.event != SDL_WINDOWEVENT_EXPOSED && pEvent->window.event != SDL_WINDOWEVENT_SIZE_CHANGED))
+	{
+		return 0;
+	}
+
+	Window* pWindow = static_cast<EventPump*>(pUserData)->Find(pEvent->window.windowID);
+	if (pWindow != nullptr)
+	{
+		pWindow->Expose(*pEvent);
+	}
+
+	return 0;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <SDL.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Window;
+
+// An SDL event and when the pump thread received it.
+struct QueuedEvent
+{
+	SDL_Event event;
+	std::chrono::steady_clock::time_point received;
+	// Window moves and size changes only. Display state is read on the pump thread, which owns SDL's video subsystem.
+	bool offScreen;
+	int refreshRate;
+	int cursorX;
+	int cursorY;
+};
+
+// One window's events. Single producer, single consumer: the pump thread pushes, the main thread pops.
+class EventRing
+{
+public:
+	static const unsigned int Capacity = 256;
+
+	EventRing();
+	// Once the ring is three quarters full mouse motion is dropped first, so buttons and keys still fit.
+	// The next motion event carries the cursor anyway.
+	void Push(const QueuedEvent& event);
+	bool Pop(QueuedEvent& event);
+	unsigned int GetDropped() const;
+
+private:
+	QueuedEvent _events[Capacity];
+	// Free running, wrapped on access. Each is only written by one side.
+	std::atomic<unsigned int> _read;
+	std::atomic<unsigned int> _write;
+	std::atomic<unsigned int> _dropped;
+};
+
+// Owns SDL's video subsystem on a thread of its own. SDL windows belong to the thread that pumps their messages, so
+// they are created and destroyed here too, and their events keep flowing however long Unity's frame takes.
+// Events are queued into each window's EventRing as they arrive and applied by UpdateWindows.
+class EventPump
+{
+public:
+	EventPump();
+	~EventPump();
+
+	// Starts the thread and initialises SDL's video subsystem on it. Returns false if SDL could not be initialised.
+	bool Start();
+	// Runs the commands already queued, shuts SDL down and joins the thread.
+	void Stop();
+
+	// Runs command on the pump thread and waits for it to finish. Windows that are being moved or sized by the user
+	// hold the pump thread in a modal loop, the caller waits until the user lets go.
+	void Invoke(const std::function<void()>& command);
+	// Queues command to run on the pump thread without waiting for it.
+	void Post(std::function<void()> command);
+
+	// Pump thread only. Routes events to the window from now on.
+	void Register(Window* pWindow);
+	void Unregister(Window* pWindow);
+	// Pump thread only. nullptr once the window was unregistered.
+	Window* Find(Uint32 windowId) const;
+
+private:
+	void Run();
+	bool RunCommands();
+	void Route(const SDL_Event& event);
+	void Wait();
+	void Wake();
+	static int SDLCALL OnEventAdded(void* pUserData, SDL_Event* pEvent);
+
+	std::thread _thread;
+	std::mutex _mutex;
+	std::condition_variable _completed;
+	std::vector<std::function<void()>> _commands;
+	bool _stopping;
+
+	// Pump thread only.
+	std::vector<std::function<void()>> _running;
+	// By SDL window ID, looked up for every event.
+	std::unordered_map<Uint32, Window*> _windows;
+
+#ifdef _WIN32
+	// Auto-reset event set by Wake. Unlike a thread message it cannot be swallowed by SDL's PeekMessage loop.
+	void* _wakeEvent;
+#else
+	// eventfd written by Wake.
+	int _wakeFd;
+	// Pump thread only. SDL's X11 connection, taken from the first window registered, or -1.
+	int _displayFd;
+#endif
+};
@@ -0,0 +1,17 @@
+#ifdef __linux__
+#include <SDL.h>
+#include "SDL_syswm.h"
+
+// Kept apart from EventPump.cpp, Xlib's Window type clashes with the plugin's Window class.
+int GetX11ConnectionNumber(SDL_Window* pWindow)
+{
+	SDL_SysWMinfo info;
+	SDL_VERSION(&info.version);
+	if (pWindow == nullptr || !SDL_GetWindowWMInfo(pWindow, &info) || info.subsystem != SDL_SYSWM_X11)
+	{
+		return -1;
+	}
+
+	return ConnectionNumber(info.info.x11.display);
+}
+#endif
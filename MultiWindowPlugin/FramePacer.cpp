@@ -0,0 +1,83 @@
+#include "FramePacer.h"
+#include <algorithm>
+
+// Upper bound on how long the render thread will block on the GPU in FramePacingFence mode.
+static const GLuint64 MaxFenceWaitNanoseconds = 100000000;
+
+FramePacer::FramePacer()
+	: _requestedMode(FramePacingFence)
+	, _requestedFramesInFlight(2)
+	, _mode(FramePacingFence)
+	, _framesInFlight(2)
+	, _fences()
+	, _oldestFence(0)
+	, _fenceCount(0)
+{
+}
+
+void FramePacer::Configure(FramePacingMode mode, int framesInFlight)
+{
+	_requestedFramesInFlight = std::min(std::max(framesInFlight, 1), MaxFramesInFlight);
+	_requestedMode = mode;
+}
+
+bool FramePacer::BeginFrame()
+{
+	const FramePacingMode requestedMode = FramePacingMode(_requestedMode.load());
+	const int requestedFramesInFlight = _requestedFramesInFlight.load();
+	if (requestedMode != _mode || requestedFramesInFlight != _framesInFlight)
+	{
+		Reset();
+		_mode = requestedMode;
+		_framesInFlight = requestedFramesInFlight;
+	}
+
+	if (_mode == FramePacingFinish || _fenceCount < _framesInFlight)
+	{
+		return true;
+	}
+
+	return WaitForOldestFrame(_mode == FramePacingFenceSkip ? 0 : MaxFenceWaitNanoseconds);
+}
+
+void FramePacer::EndFrame()
+{
+	if (_mode == FramePacingFinish)
+	{
+		glFinish();
+		return;
+	}
+
+	const int newestFence = (_oldestFence + _fenceCount) % MaxFramesInFlight;
+	_fences[newestFence] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	++_fenceCount;
+}
+
+void FramePacer::Reset()
+{
+	while (_fenceCount > 0)
+	{
+		glDeleteSync(_fences[_oldestFence]);
+		_fences[_oldestFence] = nullptr;
+		_oldestFence = (_oldestFence + 1) % MaxFramesInFlight;
+		--_fenceCount;
+	}
+
+	_oldestFence = 0;
+}
+
+bool FramePacer::WaitForOldestFrame(GLuint64 timeout)
+{
+	const GLenum result = glClientWaitSync(_fences[_oldestFence], GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		return false;
+	}
+
+	// Signalled (or the wait failed, in which case the fence is useless anyway).
+	glDeleteSync(_fences[_oldestFence]);
+	_fences[_oldestFence] = nullptr;
+	_oldestFence = (_oldestFence + 1) % MaxFramesInFlight;
+	--_fenceCount;
+	return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+
+enum FramePacingMode
+{
+	// Drain the GPU once after all windows have been presented.
+	FramePacingFinish = 0,
+	// Allow up to N frames in flight, waiting (bounded) on the oldest fence when the limit is reached.
+	FramePacingFence = 1,
+	// Allow up to N frames in flight, skipping the present entirely if the GPU is still behind.
+	FramePacingFenceSkip = 2
+};
+
+class FramePacer
+{
+public:
+	static const int MaxFramesInFlight = 4;
+
+	FramePacer();
+
+	// May be called from any thread, the change is picked up by the next BeginFrame.
+	void Configure(FramePacingMode mode, int framesInFlight);
+
+	// Render thread only. Returns false if this frame should not be presented.
+	bool BeginFrame();
+	void EndFrame();
+	void Reset();
+
+private:
+	bool WaitForOldestFrame(GLuint64 timeout);
+
+	std::atomic<int> _requestedMode;
+	std::atomic<int> _requestedFramesInFlight;
+
+	FramePacingMode _mode;
+	int _framesInFlight;
+	GLsync _fences[MaxFramesInFlight];
+	int _oldestFence;
+	int _fenceCount;
+};
@@ -0,0 +1,176 @@
+#include "GLDiagnostics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+struct IdCount
+{
+	GLuint id;
+	unsigned int delivered;
+};
+
+static std::atomic<int> _level(DiagnosticsOff);
+
+// Guards everything below. The callback can be raised on any thread with a context, but never allocates.
+static std::mutex _mutex;
+static DiagnosticMessage _pending[GLDiagnostics::MaxPending];
+static int _pendingCount = 0;
+static unsigned int _dropped = 0;
+static std::chrono::steady_clock::time_point _rateWindowStart;
+static int _rateWindowCount = 0;
+// Open addressing on the message ID. Once full, new IDs are no longer capped, which only matters for very noisy drivers.
+static const int IdTableSize = 256;
+static IdCount _idCounts[IdTableSize];
+
+static int SeverityLevel(GLenum severity)
+{
+	switch (severity)
+	{
+	case GL_DEBUG_SEVERITY_HIGH:
+		return DiagnosticsHigh;
+	case GL_DEBUG_SEVERITY_MEDIUM:
+		return DiagnosticsMedium;
+	case GL_DEBUG_SEVERITY_LOW:
+		return DiagnosticsLow;
+	default:
+		return DiagnosticsAll;
+	}
+}
+
+static IdCount* FindIdCount(GLuint id)
+{
+	for (int probe = 0; probe < IdTableSize; ++probe)
+	{
+		IdCount& entry = _idCounts[(id + probe) % IdTableSize];
+		if (entry.id == id || entry.delivered == 0)
+		{
+			entry.id = id;
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+void GLDiagnostics::SetLevel(DiagnosticsLevel level)
+{
+	_level = level;
+}
+
+bool GLDiagnostics::IsEnabled()
+{
+	return _level.load(std::memory_order_relaxed) != DiagnosticsOff;
+}
+
+void GLDiagnostics::UpdateContext(DiagnosticsContext& context)
+{
+	if (IsEnabled() == context.installed)
+	{
+		return;
+	}
+
+	if (context.installed)
+	{
+		ReleaseContext(context);
+		return;
+	}
+
+	if (!GLEW_KHR_debug && !GLEW_VERSION_4_3)
+	{
+		return;
+	}
+
+	glGetPointerv(GL_DEBUG_CALLBACK_FUNCTION, reinterpret_cast<void**>(&context.previousCallback));
+	glGetPointerv(GL_DEBUG_CALLBACK_USER_PARAM, const_cast<void**>(&context.pPreviousUserParam));
+	context.previousOutput = glIsEnabled(GL_DEBUG_OUTPUT);
+
+	glDebugMessageCallback(OnMessage, nullptr);
+	glEnable(GL_DEBUG_OUTPUT);
+	context.installed = true;
+}
+
+void GLDiagnostics::ReleaseContext(DiagnosticsContext& context)
+{
+	if (!context.installed)
+	{
+		return;
+	}
+
+	glDebugMessageCallback(context.previousCallback, context.pPreviousUserParam);
+	if (context.previousOutput == GL_FALSE)
+	{
+		glDisable(GL_DEBUG_OUTPUT);
+	}
+	context = DiagnosticsContext();
+}
+
+void GLAPIENTRY GLDiagnostics::OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* /*userParam*/)
+{
+	if (SeverityLevel(severity) > _level.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (int i = 0; i < _pendingCount; ++i)
+	{
+		if (_pending[i].id == id && _pending[i].source == source)
+		{
+			++_pending[i].count;
+			return;
+		}
+	}
+
+	IdCount* pIdCount = FindIdCount(id);
+	if (pIdCount != nullptr && pIdCount->delivered >= MaxDeliveriesPerId)
+	{
+		++_dropped;
+		return;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if (now - _rateWindowStart >= std::chrono::seconds(1))
+	{
+		_rateWindowStart = now;
+		_rateWindowCount = 0;
+	}
+
+	if (_rateWindowCount == MaxMessagesPerSecond || _pendingCount == MaxPending)
+	{
+		++_dropped;
+		return;
+	}
+	++_rateWindowCount;
+
+	if (pIdCount != nullptr)
+	{
+		++pIdCount->delivered;
+	}
+
+	DiagnosticMessage& pending = _pending[_pendingCount++];
+	pending.id = id;
+	pending.source = source;
+	pending.type = type;
+	pending.severity = severity;
+	pending.count = 1;
+
+	// Length is negative for null terminated messages on some drivers.
+	const size_t textLength = std::min(length < 0 ? std::strlen(message) : size_t(length), sizeof(pending.text) - 1);
+	std::memcpy(pending.text, message, textLength);
+	pending.text[textLength] = '\0';
+}
+
+int GLDiagnostics::Poll(DiagnosticMessage* messages, int capacity, unsigned int* dropped)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	const int count = std::min(std::max(capacity, 0), _pendingCount);
+	std::copy(_pending, _pending + count, messages);
+	std::copy(_pending + count, _pending + _pendingCount, _pending);
+	_pendingCount -= count;
+
+	*dropped = _dropped;
+	_dropped = 0;
+	return count;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Lowest severity reported, mirrored in WindowManager.cs.
+enum DiagnosticsLevel : int
+{
+	DiagnosticsOff = 0,
+	DiagnosticsHigh = 1,
+	DiagnosticsMedium = 2,
+	DiagnosticsLow = 3,
+	// Includes notifications, which some drivers raise for every buffer allocation.
+	DiagnosticsAll = 4
+};
+
+// Mirrored in WindowManager.cs. Source, type and severity are the GL_DEBUG_* enums.
+struct DiagnosticMessage
+{
+	unsigned int id;
+	unsigned int source;
+	unsigned int type;
+	unsigned int severity;
+	// Times the message was raised since it was last delivered, repeats are folded into one entry.
+	unsigned int count;
+	char text[244];
+};
+
+// Per context, on the thread the context is current on.
+struct DiagnosticsContext
+{
+	bool installed;
+	GLDEBUGPROC previousCallback;
+	const void* pPreviousUserParam;
+	GLboolean previousOutput;
+};
+
+// Captures GL errors and warnings through KHR_debug rather than polling glGetError, which stalls the pipeline.
+// Messages are filtered by severity, repeats of an ID are folded together and capped, new messages are rate limited,
+// and they wait in a fixed queue until managed code polls them. With diagnostics off nothing is installed on any context.
+class GLDiagnostics
+{
+public:
+	static const int MaxPending = 32;
+	static const int MaxMessagesPerSecond = 20;
+	// Once an ID has been delivered this often it is only counted as dropped.
+	static const unsigned int MaxDeliveriesPerId = 3;
+
+	// Any thread, contexts pick the change up the next time they are updated.
+	static void SetLevel(DiagnosticsLevel level);
+	static bool IsEnabled();
+
+	// Installs or removes the callback on the current context to match the level.
+	static void UpdateContext(DiagnosticsContext& context);
+	// Gives back whatever callback the context had before, Unity may have installed its own.
+	static void ReleaseContext(DiagnosticsContext& context);
+
+	// Main thread. Moves up to capacity pending messages into messages and returns how many were moved.
+	static int Poll(DiagnosticMessage* messages, int capacity, unsigned int* dropped);
+
+private:
+	static void GLAPIENTRY OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
+};
@@ -0,0 +1,23 @@
+#include "GLPlatform.h"
+
+#ifdef _WIN32
+GLPlatform* CreateWGLPlatform();
+#else
+GLPlatform* CreateEGLPlatform();
+GLPlatform* CreateGLXPlatform();
+#endif
+
+GLPlatform* GLPlatform::Create()
+{
+#ifdef _WIN32
+	return CreateWGLPlatform();
+#else
+	// Only one of them reports a context current on this thread.
+	GLPlatform* pPlatform = CreateEGLPlatform();
+	if (pPlatform == nullptr)
+	{
+		pPlatform = CreateGLXPlatform();
+	}
+	return pPlatform;
+#endif
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SDL.h>
+
+// Opaque window-system handles: an HDC and HGLRC under WGL, an X11 drawable and GLXContext under GLX,
+// an EGLSurface and EGLContext under EGL.
+typedef void* PlatformDrawable;
+typedef void* PlatformContext;
+
+// Binds the plugin's windows to Unity's GL context, so Window and Presenter do not depend on a window system.
+class GLPlatform
+{
+public:
+	virtual ~GLPlatform() {}
+
+	// Render thread, with Unity's context current. Picks the window-system API that owns that context.
+	static GLPlatform* Create();
+
+	virtual const char* Name() const = 0;
+
+	// Event pump thread. Drawables are created for SDL windows made with SDL_WINDOW_OPENGL and live as long as the window.
+	virtual PlatformDrawable CreateDrawable(SDL_Window* pWindow) = 0;
+	virtual void DestroyDrawable(PlatformDrawable drawable) = 0;
+
+	// Render thread. Presenting rebinds Unity's context to each window in turn, EndPresent gives it back its own drawable.
+	virtual void BeginPresent() = 0;
+	virtual bool MakeUnityContextCurrent(PlatformDrawable drawable) = 0;
+	virtual void EndPresent() = 0;
+
+	// Render thread, with Unity's context current. Returns nullptr if the platform cannot share Unity's objects.
+	// Debug contexts report more through KHR_debug, they are only asked for while diagnostics are enabled.
+	virtual PlatformContext CreateSharedContext(PlatformDrawable drawable, bool debug) = 0;
+
+	// Any thread.
+	virtual bool MakeCurrent(PlatformDrawable drawable, PlatformContext context) = 0;
+	virtual void ReleaseCurrent() = 0;
+	virtual void DestroyContext(PlatformContext context) = 0;
+	virtual void SwapBuffers(PlatformDrawable drawable) = 0;
+	// With a context current on the drawable. Negative intervals ask for adaptive vsync. Returns the interval the
+	// drawable swaps with afterwards, 1 where it cannot be controlled as drivers default to swapping on vblank.
+	virtual int SetSwapInterval(PlatformDrawable drawable, int interval) = 0;
+};
@@ -0,0 +1,222 @@
+#include "GLStateCache.h"
+#include <atomic>
+
+static const GLuint Unknown = ~0u;
+
+// Shared by the render thread and all presenter threads.
+static std::atomic<unsigned int> _elidedBinds(0);
+static std::atomic<unsigned int> _avoidedUniformLookups(0);
+static std::atomic<unsigned int> _avoidedTexParameters(0);
+
+GLStateCache::GLStateCache(bool restoreUnityState)
+	: _restoreUnityState(restoreUnityState)
+	, _saved(false)
+	, _unityState()
+{
+	BeginPass();
+}
+
+void GLStateCache::BeginPass()
+{
+	// Unity may have changed anything since the last pass.
+	_drawFramebuffer = Unknown;
+	_readFramebuffer = Unknown;
+	_vao = Unknown;
+	_program = Unknown;
+	_texture = Unknown;
+	_sampler = Unknown;
+	_viewportWidth = -1;
+	_viewportHeight = -1;
+	_texcoordScale[0] = -1.0f;
+	_texcoordScale[1] = -1.0f;
+	_capabilitiesDisabled = false;
+	_saved = false;
+}
+
+void GLStateCache::EndPass()
+{
+	if (!_saved)
+	{
+		return;
+	}
+
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _unityState.drawFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, _unityState.readFramebuffer);
+	glBindVertexArray(_unityState.vao);
+	glUseProgram(_unityState.program);
+	glBindTexture(GL_TEXTURE_2D, _unityState.texture);
+	glBindSampler(0, _unityState.sampler);
+	glActiveTexture(_unityState.activeTexture);
+	glViewport(_unityState.viewport[0], _unityState.viewport[1], _unityState.viewport[2], _unityState.viewport[3]);
+	glVertexAttrib4fv(TexcoordScaleAttribute, _unityState.texcoordScale);
+
+	if (_unityState.depthTest) glEnable(GL_DEPTH_TEST);
+	if (_unityState.blend) glEnable(GL_BLEND);
+	if (_unityState.scissorTest) glEnable(GL_SCISSOR_TEST);
+	if (_unityState.cullFace) glEnable(GL_CULL_FACE);
+
+	_saved = false;
+}
+
+void GLStateCache::Save()
+{
+	if (!_restoreUnityState || _saved)
+	{
+		return;
+	}
+
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_unityState.drawFramebuffer);
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &_unityState.readFramebuffer);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &_unityState.vao);
+	glGetIntegerv(GL_CURRENT_PROGRAM, &_unityState.program);
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &_unityState.activeTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &_unityState.texture);
+	glGetIntegerv(GL_SAMPLER_BINDING, &_unityState.sampler);
+	glGetIntegerv(GL_VIEWPORT, _unityState.viewport);
+	glGetVertexAttribfv(TexcoordScaleAttribute, GL_CURRENT_VERTEX_ATTRIB, _unityState.texcoordScale);
+	_unityState.depthTest = glIsEnabled(GL_DEPTH_TEST);
+	_unityState.blend = glIsEnabled(GL_BLEND);
+	_unityState.scissorTest = glIsEnabled(GL_SCISSOR_TEST);
+	_unityState.cullFace = glIsEnabled(GL_CULL_FACE);
+	_saved = true;
+}
+
+void GLStateCache::BindDrawFramebuffer(GLuint framebuffer)
+{
+	if (_drawFramebuffer == framebuffer)
+	{
+		Elided();
+		return;
+	}
+
+	Save();
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+	_drawFramebuffer = framebuffer;
+}
+
+void GLStateCache::BindReadFramebuffer(GLuint framebuffer)
+{
+	if (_readFramebuffer == framebuffer)
+	{
+		Elided();
+		return;
+	}
+
+	Save();
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	_readFramebuffer = framebuffer;
+}
+
+void GLStateCache::BindVertexArray(GLuint vao)
+{
+	if (_vao == vao)
+	{
+		Elided();
+		return;
+	}
+
+	Save();
+	glBindVertexArray(vao);
+	_vao = vao;
+}
+
+void GLStateCache::UseProgram(GLuint program)
+{
+	if (_program == program)
+	{
+		Elided();
+		return;
+	}
+
+	Save();
+	glUseProgram(program);
+	_program = program;
+}
+
+void GLStateCache::BindTexture(GLuint texture)
+{
+	if (_texture == texture)
+	{
+		Elided();
+		return;
+	}
+
+	Save();
+	glBindTexture(GL_TEXTURE_2D, texture);
+	_texture = texture;
+}
+
+void GLStateCache::BindSampler(GLuint sampler)
+{
+	if (_sampler == sampler)
+	{
+		Elided();
+		return;
+	}
+
+	Save();
+	glBindSampler(0, sampler);
+	_sampler = sampler;
+}
+
+void GLStateCache::Viewport(int width, int height)
+{
+	if (_viewportWidth == width && _viewportHeight == height)
+	{
+		Elided();
+		return;
+	}
+
+	Save();
+	glViewport(0, 0, width, height);
+	_viewportWidth = width;
+	_viewportHeight = height;
+}
+
+void GLStateCache::TexcoordScale(float x, float y)
+{
+	if (_texcoordScale[0] == x && _texcoordScale[1] == y)
+	{
+		Elided();
+		return;
+	}
+
+	Save();
+	glVertexAttrib2f(TexcoordScaleAttribute, x, y);
+	_texcoordScale[0] = x;
+	_texcoordScale[1] = y;
+}
+
+void GLStateCache::DisableCapabilities()
+{
+	if (_capabilitiesDisabled)
+	{
+		return;
+	}
+
+	Save();
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+	glDisable(GL_SCISSOR_TEST);
+	glDisable(GL_CULL_FACE);
+	_capabilitiesDisabled = true;
+}
+
+void GLStateCache::CountDraw()
+{
+	++_avoidedUniformLookups;
+	_avoidedTexParameters += 4;
+}
+
+void GLStateCache::GetCounters(GLStateCounters& counters)
+{
+	counters.elidedBinds = _elidedBinds;
+	counters.avoidedUniformLookups = _avoidedUniformLookups;
+	counters.avoidedTexParameters = _avoidedTexParameters;
+}
+
+void GLStateCache::Elided()
+{
+	++_elidedBinds;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Blittable, mirrored in WindowManager.cs.
+struct GLStateCounters
+{
+	// Binds skipped because the object was already bound by a previous window in the same pass.
+	unsigned int elidedBinds;
+	// glGetUniformLocation calls no longer made per present, the uniform is resolved once at load.
+	unsigned int avoidedUniformLookups;
+	// glTexParameteri calls no longer made per present, filtering comes from a sampler object.
+	unsigned int avoidedTexParameters;
+};
+
+// Tracks the GL bindings used by the present path on one context, so consecutive windows do not rebind the same objects.
+// On Unity's context the state the plugin touches is saved on first use in a pass and restored at the end of it.
+class GLStateCache
+{
+public:
+	explicit GLStateCache(bool restoreUnityState);
+
+	void BeginPass();
+	void EndPass();
+
+	void BindDrawFramebuffer(GLuint framebuffer);
+	void BindReadFramebuffer(GLuint framebuffer);
+	void BindVertexArray(GLuint vao);
+	void UseProgram(GLuint program);
+	void BindTexture(GLuint texture);
+	void BindSampler(GLuint sampler);
+	void Viewport(int width, int height);
+	void TexcoordScale(float x, float y);
+	void DisableCapabilities();
+
+	// Generic attribute scaling the quad's texcoords to the part of the texture in use. Its current value is context
+	// state rather than program state, so presenter threads sharing the program never see each other's value.
+	static const GLuint TexcoordScaleAttribute = 2;
+
+	static void CountDraw();
+	static void GetCounters(GLStateCounters& counters);
+
+private:
+	void Save();
+	static void Elided();
+
+	const bool _restoreUnityState;
+	bool _saved;
+
+	GLuint _drawFramebuffer;
+	GLuint _readFramebuffer;
+	GLuint _vao;
+	GLuint _program;
+	GLuint _texture;
+	GLuint _sampler;
+	int _viewportWidth;
+	int _viewportHeight;
+	float _texcoordScale[2];
+	bool _capabilitiesDisabled;
+
+	struct SavedState
+	{
+		GLint drawFramebuffer;
+		GLint readFramebuffer;
+		GLint vao;
+		GLint program;
+		GLint activeTexture;
+		GLint texture;
+		GLint sampler;
+		GLint viewport[4];
+		GLfloat texcoordScale[4];
+		GLboolean depthTest;
+		GLboolean blend;
+		GLboolean scissorTest;
+		GLboolean cullFace;
+	} _unityState;
+};
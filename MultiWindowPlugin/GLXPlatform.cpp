@@ -0,0 +1,244 @@
+#ifdef __linux__
+#include "GLPlatform.h"
+#include <GL/glew.h>
+#include <GL/glxew.h>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include "SDL_syswm.h"
+
+// UnityInterface.h declares the plugin's Window class, which Xlib's Window typedef clashes with.
+void Log(const std::string& message);
+
+// Unity's default OpenGL Core context on Linux. Presenter threads share Unity's Display connection,
+// which relies on Xlib having been initialised for threads.
+class GLXPlatform : public GLPlatform
+{
+public:
+	GLXPlatform(Display* pDisplay, GLXContext unityContext, GLXFBConfig config)
+		: _pDisplay(pDisplay)
+		, _unityContext(unityContext)
+		, _config(config)
+		, _unityDrawable(None)
+		, _unityReadDrawable(None)
+	{
+	}
+
+	const char* Name() const override
+	{
+		return "GLX";
+	}
+
+	PlatformDrawable CreateDrawable(SDL_Window* pWindow) override
+	{
+		SDL_SysWMinfo info;
+		SDL_VERSION(&info.version);
+		if (!SDL_GetWindowWMInfo(pWindow, &info) || info.subsystem != SDL_SYSWM_X11)
+		{
+			return nullptr;
+		}
+
+		// X11 window IDs are global to the server, so SDL's window can be used through Unity's connection.
+		if (!IsCompatible(info.info.x11.window))
+		{
+			Log("SDL created a window whose visual does not match Unity's context, it cannot be presented with GLX.");
+			return nullptr;
+		}
+		return ToDrawable(info.info.x11.window);
+	}
+
+	void DestroyDrawable(PlatformDrawable /*drawable*/) override
+	{
+	}
+
+	void BeginPresent() override
+	{
+		_unityDrawable = glXGetCurrentDrawable();
+		_unityReadDrawable = glXGetCurrentReadDrawable();
+	}
+
+	bool MakeUnityContextCurrent(PlatformDrawable drawable) override
+	{
+		return glXMakeCurrent(_pDisplay, FromDrawable(drawable), _unityContext) != False;
+	}
+
+	void EndPresent() override
+	{
+		glXMakeContextCurrent(_pDisplay, _unityDrawable, _unityReadDrawable, _unityContext);
+	}
+
+	PlatformContext CreateSharedContext(PlatformDrawable /*drawable*/, bool debug) override
+	{
+		if (!GLXEW_ARB_create_context || _config == nullptr)
+		{
+			return nullptr;
+		}
+
+		GLint majorVersion, minorVersion;
+		glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+		glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+		const int attributes[] = {
+			GLX_CONTEXT_MAJOR_VERSION_ARB, majorVersion,
+			GLX_CONTEXT_MINOR_VERSION_ARB, minorVersion,
+			GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+			GLX_CONTEXT_FLAGS_ARB, debug ? GLX_CONTEXT_DEBUG_BIT_ARB : 0,
+			None
+		};
+
+		return glXCreateContextAttribsARB(_pDisplay, _config, _unityContext, True, attributes);
+	}
+
+	bool MakeCurrent(PlatformDrawable drawable, PlatformContext context) override
+	{
+		return glXMakeCurrent(_pDisplay, FromDrawable(drawable), GLXContext(context)) != False;
+	}
+
+	void ReleaseCurrent() override
+	{
+		glXMakeCurrent(_pDisplay, None, nullptr);
+	}
+
+	void DestroyContext(PlatformContext context) override
+	{
+		glXDestroyContext(_pDisplay, GLXContext(context));
+	}
+
+	void SwapBuffers(PlatformDrawable drawable) override
+	{
+		glXSwapBuffers(_pDisplay, FromDrawable(drawable));
+	}
+
+	int SetSwapInterval(PlatformDrawable drawable, int interval) override
+	{
+		if (interval < 0 && !GLXEW_EXT_swap_control_tear)
+		{
+			interval = 1;
+		}
+
+		if (GLXEW_EXT_swap_control)
+		{
+			// The queried interval stays positive, adaptive swapping is reported separately.
+			glXSwapIntervalEXT(_pDisplay, FromDrawable(drawable), interval);
+			unsigned int swapInterval = 1, lateSwapsTear = 0;
+			glXQueryDrawable(_pDisplay, FromDrawable(drawable), GLX_SWAP_INTERVAL_EXT, &swapInterval);
+			if (GLXEW_EXT_swap_control_tear)
+			{
+				glXQueryDrawable(_pDisplay, FromDrawable(drawable), GLX_LATE_SWAPS_TEAR_EXT, &lateSwapsTear);
+			}
+			return lateSwapsTear != 0 ? -int(swapInterval) : int(swapInterval);
+		}
+
+		// The Mesa extension applies to the current drawable and has no adaptive interval.
+		if (GLXEW_MESA_swap_control)
+		{
+			glXSwapIntervalMESA(unsigned(std::abs(interval)));
+			return glXGetSwapIntervalMESA();
+		}
+
+		return 1;
+	}
+
+private:
+	// SDL picks the window's visual from its own GL attributes. Making Unity's context current on a window whose
+	// framebuffer configuration differs raises BadMatch, which Xlib's default handler turns into exit().
+	bool IsCompatible(::Window window) const
+	{
+		XWindowAttributes windowAttributes;
+		if (_config == nullptr || XGetWindowAttributes(_pDisplay, window, &windowAttributes) == 0)
+		{
+			return _config == nullptr;
+		}
+
+		int unityVisual = 0;
+		glXGetFBConfigAttrib(_pDisplay, _config, GLX_VISUAL_ID, &unityVisual);
+		if (VisualID(unityVisual) == XVisualIDFromVisual(windowAttributes.visual))
+		{
+			return true;
+		}
+
+		// Another visual with the same buffers is still compatible.
+		int configCount = 0;
+		GLXFBConfig* pConfigs = glXGetFBConfigs(_pDisplay, XScreenNumberOfScreen(windowAttributes.screen), &configCount);
+		bool compatible = false;
+		for (int i = 0; i < configCount; ++i)
+		{
+			int visual = 0;
+			glXGetFBConfigAttrib(_pDisplay, pConfigs[i], GLX_VISUAL_ID, &visual);
+			if (VisualID(visual) == XVisualIDFromVisual(windowAttributes.visual) && HasSameBuffers(pConfigs[i]))
+			{
+				compatible = true;
+				break;
+			}
+		}
+
+		if (pConfigs != nullptr)
+		{
+			XFree(pConfigs);
+		}
+		return compatible;
+	}
+
+	bool HasSameBuffers(GLXFBConfig config) const
+	{
+		static const int attributes[] = { GLX_RENDER_TYPE, GLX_DOUBLEBUFFER, GLX_RED_SIZE, GLX_GREEN_SIZE, GLX_BLUE_SIZE, GLX_ALPHA_SIZE, GLX_DEPTH_SIZE, GLX_STENCIL_SIZE };
+		for (const int attribute : attributes)
+		{
+			int value = 0, unityValue = 0;
+			glXGetFBConfigAttrib(_pDisplay, config, attribute, &value);
+			glXGetFBConfigAttrib(_pDisplay, _config, attribute, &unityValue);
+			if (value != unityValue)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static PlatformDrawable ToDrawable(::Window window)
+	{
+		return reinterpret_cast<PlatformDrawable>(uintptr_t(window));
+	}
+
+	static GLXDrawable FromDrawable(PlatformDrawable drawable)
+	{
+		return GLXDrawable(reinterpret_cast<uintptr_t>(drawable));
+	}
+
+	Display* const _pDisplay;
+	const GLXContext _unityContext;
+	const GLXFBConfig _config;
+	GLXDrawable _unityDrawable;
+	GLXDrawable _unityReadDrawable;
+};
+
+GLPlatform* CreateGLXPlatform()
+{
+	const GLXContext unityContext = glXGetCurrentContext();
+	Display* pDisplay = glXGetCurrentDisplay();
+	if (unityContext == nullptr || pDisplay == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Shared contexts must be created with the same framebuffer configuration as Unity's.
+	GLXFBConfig config = nullptr;
+	int configId, screen;
+	if (glXQueryContext(pDisplay, unityContext, GLX_FBCONFIG_ID, &configId) == Success && glXQueryContext(pDisplay, unityContext, GLX_SCREEN, &screen) == Success)
+	{
+		const int attributes[] = { GLX_FBCONFIG_ID, configId, None };
+		int configCount = 0;
+		GLXFBConfig* pConfigs = glXChooseFBConfig(pDisplay, screen, attributes, &configCount);
+		if (pConfigs != nullptr)
+		{
+			if (configCount > 0)
+			{
+				config = pConfigs[0];
+			}
+			XFree(pConfigs);
+		}
+	}
+
+	return new GLXPlatform(pDisplay, unityContext, config);
+}
+#endif
@@ -0,0 +1,94 @@
+#include "GpuTimer.h"
+
+std::atomic<bool> GpuTimer::_enabled(false);
+
+GpuTimer::GpuTimer(int capacity)
+	: _measurements(capacity)
+	, _oldest(0)
+	, _count(0)
+	, _supported(true)
+{
+}
+
+void GpuTimer::SetEnabled(bool enabled)
+{
+	_enabled = enabled;
+}
+
+bool GpuTimer::Begin(unsigned long long tag)
+{
+	if (!_enabled || !_supported || _count == int(_measurements.size()))
+	{
+		return false;
+	}
+
+	// Queries are created on first use, on the context they belong to.
+	if (_measurements[0].queries[0] == 0)
+	{
+		_supported = GLEW_ARB_timer_query || GLEW_VERSION_3_3;
+		if (!_supported)
+		{
+			return false;
+		}
+
+		for (Measurement& measurement : _measurements)
+		{
+			glGenQueries(2, measurement.queries);
+		}
+	}
+
+	Measurement& measurement = _measurements[(_oldest + _count) % _measurements.size()];
+	measurement.tag = tag;
+	glQueryCounter(measurement.queries[0], GL_TIMESTAMP);
+	return true;
+}
+
+void GpuTimer::End()
+{
+	Measurement& measurement = _measurements[(_oldest + _count) % _measurements.size()];
+	glQueryCounter(measurement.queries[1], GL_TIMESTAMP);
+	++_count;
+}
+
+bool GpuTimer::Collect(unsigned long long& tag, float& milliseconds)
+{
+	if (_count == 0)
+	{
+		return false;
+	}
+
+	// Queries complete in order, once the end timestamp is available so is the start.
+	Measurement& measurement = _measurements[_oldest];
+	GLint available = 0;
+	glGetQueryObjectiv(measurement.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available == 0)
+	{
+		return false;
+	}
+
+	GLuint64 start, end;
+	glGetQueryObjectui64v(measurement.queries[0], GL_QUERY_RESULT, &start);
+	glGetQueryObjectui64v(measurement.queries[1], GL_QUERY_RESULT, &end);
+	tag = measurement.tag;
+	milliseconds = float(end - start) / 1000000.0f;
+
+	_oldest = (_oldest + 1) % int(_measurements.size());
+	--_count;
+	return true;
+}
+
+void GpuTimer::Release()
+{
+	for (Measurement& measurement : _measurements)
+	{
+		if (measurement.queries[0] != 0)
+		{
+			glDeleteQueries(2, measurement.queries);
+		}
+		measurement = Measurement();
+	}
+
+	_oldest = 0;
+	_count = 0;
+	_supported = true;
+}
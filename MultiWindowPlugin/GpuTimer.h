@@ -0,0 +1,40 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+#include <vector>
+
+// Measures GPU time between two points on one context with pairs of GL_TIMESTAMP queries. Timestamps rather than
+// GL_TIME_ELAPSED, so timing on Unity's context cannot collide with a query Unity itself has active.
+// Queries form a ring and are only read back once available, so a measurement never stalls; when every query is still
+// in flight the sample is dropped instead. Only used on the thread the context is current on.
+class GpuTimer
+{
+public:
+	explicit GpuTimer(int capacity);
+
+	// Any thread, picked up by the next Begin.
+	static void SetEnabled(bool enabled);
+
+	// Returns false if timing is disabled or the ring is full, End must then not be called.
+	bool Begin(unsigned long long tag);
+	void End();
+	// Pops the oldest finished measurement. Returns false if none is available yet.
+	bool Collect(unsigned long long& tag, float& milliseconds);
+	// With the context still current, before it is destroyed.
+	void Release();
+
+private:
+	struct Measurement
+	{
+		GLuint queries[2];
+		unsigned long long tag;
+	};
+
+	static std::atomic<bool> _enabled;
+
+	std::vector<Measurement> _measurements;
+	int _oldest;
+	int _count;
+	bool _supported;
+};
@@ -0,0 +1,326 @@
+// Measures the plugin outside of Unity: drives UpdateWindows and the present event through the mock Unity host on
+// Mesa and reports per-frame timings, so regressions can be tracked across releases without the editor.
+#include "MockUnity.h"
+#include "PresentStats.h"
+#include <SDL.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Size
+{
+	int width;
+	int height;
+};
+
+struct Metric
+{
+	const char* name;
+	const char* key;
+	std::vector<double> milliseconds;
+};
+
+static double ThreadCpuMilliseconds()
+{
+	timespec time;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return time.tv_sec * 1000.0 + time.tv_nsec / 1000000.0;
+}
+
+static double Milliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Nearest rank, so every reported value is one that was actually measured.
+static double Percentile(const std::vector<double>& sorted, double percentile)
+{
+	if (sorted.empty())
+	{
+		return 0.0;
+	}
+
+	const size_t rank = size_t(std::ceil(percentile / 100.0 * sorted.size()));
+	return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+}
+
+static bool ParseSizes(const char* text, std::vector<Size>& sizes)
+{
+	sizes.clear();
+	const char* cursor = text;
+	while (*cursor != '\0')
+	{
+		Size size;
+		int consumed = 0;
+		if (std::sscanf(cursor, "%dx%d%n", &size.width, &size.height, &consumed) != 2 || size.width <= 0 || size.height <= 0)
+		{
+			return false;
+		}
+
+		sizes.push_back(size);
+		cursor += consumed;
+		if (*cursor == ',')
+		{
+			++cursor;
+		}
+	}
+
+	return !sizes.empty();
+}
+
+static void PrintUsage()
+{
+	std::printf(
+		"Usage: Benchmark [options]\n"
+		"  --frames N          measured frames (600)\n"
+		"  --warmup N          frames run before measuring (60)\n"
+		"  --windows N         windows to present (4)\n"
+		"  --sizes WxH[,WxH]   window sizes, assigned round robin (1280x720)\n"
+		"  --render-scale F    render scale of every window (1.0)\n"
+		"  --threaded          present on per-window threads\n"
+		"  --vulkan            run Unity's device on Vulkan instead of OpenGL core\n"
+		"  --no-finish         do not wait for the GPU at the end of every frame\n"
+		"  --gpu-timing        time every window's draw with timer queries (OpenGL)\n"
+		"  --json PATH         also write the results as JSON\n"
+		"  --trace PATH        record the plugin's timeline and write it as Chrome trace JSON\n");
+}
+
+static void WriteJson(const char* path, const std::string& configuration, const std::vector<Metric>& metrics, unsigned int presented, unsigned int skipped)
+{
+	FILE* pFile = std::fopen(path, "w");
+	if (pFile == nullptr)
+	{
+		std::printf("Could not write %s.\n", path);
+		return;
+	}
+
+	std::fprintf(pFile, "{\n\t%s,\n\t\"presented\": %u,\n\t\"skipped\": %u,\n\t\"metrics\": {\n", configuration.c_str(), presented, skipped);
+	for (size_t i = 0; i < metrics.size(); ++i)
+	{
+		const std::vector<double>& sorted = metrics[i].milliseconds;
+		double sum = 0.0;
+		for (double value : sorted)
+		{
+			sum += value;
+		}
+
+		std::fprintf(pFile, "\t\t\"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+			metrics[i].key, sorted.empty() ? 0.0 : sum / sorted.size(), Percentile(sorted, 50.0), Percentile(sorted, 95.0), Percentile(sorted, 99.0),
+			sorted.empty() ? 0.0 : sorted.back(), i + 1 < metrics.size() ? "," : "");
+	}
+	std::fprintf(pFile, "\t}\n}\n");
+	std::fclose(pFile);
+}
+
+int main(int argc, char* argv[])
+{
+	int frameCount = 600;
+	int warmupCount = 60;
+	int windowCount = 4;
+	float renderScale = 1.0f;
+	bool threaded = false;
+	bool finish = true;
+	bool gpuTiming = false;
+	const char* jsonPath = nullptr;
+	const char* tracePath = nullptr;
+	const char* sizesText = "1280x720";
+	std::vector<Size> sizes;
+	UnityGfxRenderer renderer = kUnityGfxRendererOpenGLCore;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+		{
+			frameCount = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue)
+		{
+			warmupCount = std::max(std::atoi(argv[++i]), 0);
+		}
+		else if (std::strcmp(argv[i], "--windows") == 0 && hasValue)
+		{
+			windowCount = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (std::strcmp(argv[i], "--sizes") == 0 && hasValue)
+		{
+			sizesText = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--render-scale") == 0 && hasValue)
+		{
+			renderScale = float(std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--threaded") == 0)
+		{
+			threaded = true;
+		}
+		else if (std::strcmp(argv[i], "--vulkan") == 0)
+		{
+			renderer = kUnityGfxRendererVulkan;
+		}
+		else if (std::strcmp(argv[i], "--no-finish") == 0)
+		{
+			finish = false;
+		}
+		else if (std::strcmp(argv[i], "--gpu-timing") == 0)
+		{
+			gpuTiming = true;
+		}
+		else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+		{
+			jsonPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0 && hasValue)
+		{
+			tracePath = argv[++i];
+		}
+		else
+		{
+			PrintUsage();
+			return 2;
+		}
+	}
+
+	if (!ParseSizes(sizesText, sizes))
+	{
+		std::printf("Invalid window sizes '%s'.\n", sizesText);
+		return 2;
+	}
+
+	if (!StartMockUnity(renderer))
+	{
+		return 1;
+	}
+	SetThreadedPresentation(threaded);
+	SetGpuTiming(gpuTiming);
+	SetTraceRecording(tracePath != nullptr);
+
+	for (int i = 0; i < windowCount; ++i)
+	{
+		const Size& size = sizes[i % sizes.size()];
+		const WindowHandle window = CreateMockWindow("Benchmark", size.width, size.height);
+		if (window == 0)
+		{
+			std::printf("Could not create window %d.\n", i);
+			return 1;
+		}
+
+		// Asks for a smaller texture through the resize callback, like ExternalWindow.RenderScale does.
+		SetWindowRenderScale(window, renderScale);
+	}
+
+	std::vector<Metric> metrics = {
+		{ "UpdateWindows", "update_windows", {} },
+		{ "UpdateWindows CPU", "update_windows_cpu", {} },
+		{ "Present", "present", {} },
+		{ "GPU wait", "gpu_wait", {} },
+		{ "Frame", "frame", {} }
+	};
+	for (Metric& metric : metrics)
+	{
+		metric.milliseconds.reserve(frameCount);
+	}
+
+	const UnityRenderingEvent renderEvent = GetRenderEventFunc();
+	for (int frame = 0; frame < warmupCount + frameCount; ++frame)
+	{
+		const auto frameStart = std::chrono::steady_clock::now();
+		RenderMockFrame(frame);
+
+		const auto updateStart = std::chrono::steady_clock::now();
+		const double updateCpuStart = ThreadCpuMilliseconds();
+		UpdateMockWindows();
+		const double updateCpuEnd = ThreadCpuMilliseconds();
+		const auto updateEnd = std::chrono::steady_clock::now();
+
+		renderEvent(PresentWindowsEvent);
+		EndMockFrame();
+		const auto presentEnd = std::chrono::steady_clock::now();
+
+		if (finish)
+		{
+			FinishMockFrame();
+		}
+		const auto frameEnd = std::chrono::steady_clock::now();
+
+		if (frame < warmupCount)
+		{
+			continue;
+		}
+
+		metrics[0].milliseconds.push_back(Milliseconds(updateStart, updateEnd));
+		metrics[1].milliseconds.push_back(updateCpuEnd - updateCpuStart);
+		metrics[2].milliseconds.push_back(Milliseconds(updateEnd, presentEnd));
+		metrics[3].milliseconds.push_back(Milliseconds(presentEnd, frameEnd));
+		metrics[4].milliseconds.push_back(Milliseconds(frameStart, frameEnd));
+	}
+	FinishMockFrame();
+
+	int result = CheckMockDevice() ? 0 : 1;
+	unsigned int presented = 0;
+	unsigned int skipped = 0;
+	const std::vector<WindowHandle>& windows = GetMockWindows();
+	for (auto it = windows.begin(); it != windows.end(); ++it)
+	{
+		unsigned int windowPresented, windowSkipped;
+		GetWindowPresentCounters(*it, &windowPresented, &windowSkipped);
+		presented += windowPresented;
+		skipped += windowSkipped;
+		if (windowPresented == 0)
+		{
+			result = 1;
+		}
+	}
+
+	const char* mode = renderer == kUnityGfxRendererVulkan ? "vulkan" : threaded ? "threaded" : "render thread";
+	std::printf("%d windows at %s, render scale %.2f, %s, %d frames after %d warm-up\n", windowCount, sizesText, renderScale, mode, frameCount, warmupCount);
+	std::printf("%-20s %9s %9s %9s %9s %9s\n", "ms", "mean", "p50", "p95", "p99", "max");
+	for (Metric& metric : metrics)
+	{
+		std::vector<double>& values = metric.milliseconds;
+		std::sort(values.begin(), values.end());
+
+		double sum = 0.0;
+		for (double value : values)
+		{
+			sum += value;
+		}
+
+		std::printf("%-20s %9.3f %9.3f %9.3f %9.3f %9.3f\n", metric.name, sum / values.size(), Percentile(values, 50.0), Percentile(values, 95.0),
+			Percentile(values, 99.0), values.back());
+	}
+	std::printf("%u presents, %u skipped\n", presented, skipped);
+
+	if (gpuTiming)
+	{
+		std::vector<WindowStats> stats(windows.size());
+		GetWindowStats(stats.data(), int(stats.size()));
+		for (size_t i = 0; i < stats.size(); ++i)
+		{
+			std::printf("Window %zu GPU ms over the last %d presents: p50 %.3f, p95 %.3f, p99 %.3f\n", i, PresentStats::SampleCount,
+				stats[i].gpu.p50, stats[i].gpu.p95, stats[i].gpu.p99);
+		}
+	}
+
+	if (jsonPath != nullptr)
+	{
+		char configuration[256];
+		std::snprintf(configuration, sizeof(configuration), "\"renderer\": \"%s\", \"windows\": %d, \"sizes\": \"%s\", \"render_scale\": %.2f, \"frames\": %d, \"finish\": %s",
+			mode, windowCount, sizesText, renderScale, frameCount, finish ? "true" : "false");
+		WriteJson(jsonPath, configuration, metrics, presented, skipped);
+	}
+
+	if (tracePath != nullptr && !DumpTrace(tracePath))
+	{
+		std::printf("Could not write %s.\n", tracePath);
+	}
+
+	StopMockUnity();
+	return result;
+}
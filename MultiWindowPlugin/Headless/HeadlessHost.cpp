@@ -0,0 +1,84 @@
+// Smoke test for the present path: presents a few hundred frames through the mock Unity host on Mesa, without a GPU
+// or the editor, and fails if a window was never presented or the device reported an error.
+#include "MockUnity.h"
+#include <SDL.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char* argv[])
+{
+	int frameCount = 300;
+	int windowCount = 2;
+	bool threaded = false;
+	UnityGfxRenderer renderer = kUnityGfxRendererOpenGLCore;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			frameCount = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--windows") == 0 && i + 1 < argc)
+		{
+			windowCount = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--threaded") == 0)
+		{
+			threaded = true;
+		}
+		else if (std::strcmp(argv[i], "--vulkan") == 0)
+		{
+			renderer = kUnityGfxRendererVulkan;
+		}
+	}
+
+	if (!StartMockUnity(renderer))
+	{
+		return 1;
+	}
+	SetThreadedPresentation(threaded);
+
+	for (int i = 0; i < windowCount; ++i)
+	{
+		if (CreateMockWindow("Headless", 640, 480) == 0)
+		{
+			std::printf("Could not create window %d.\n", i);
+			return 1;
+		}
+	}
+
+	const UnityRenderingEvent renderEvent = GetRenderEventFunc();
+	const Uint64 start = SDL_GetPerformanceCounter();
+	for (int frame = 0; frame < frameCount; ++frame)
+	{
+		RenderMockFrame(frame);
+		UpdateMockWindows();
+		renderEvent(PresentWindowsEvent);
+		EndMockFrame();
+	}
+	FinishMockFrame();
+	const double seconds = double(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+	int result = 0;
+	const std::vector<WindowHandle>& windows = GetMockWindows();
+	for (auto it = windows.begin(); it != windows.end(); ++it)
+	{
+		unsigned int presented, skipped;
+		GetWindowPresentCounters(*it, &presented, &skipped);
+		if (presented == 0)
+		{
+			result = 1;
+		}
+	}
+
+	if (!CheckMockDevice())
+	{
+		result = 1;
+	}
+
+	const char* mode = renderer == kUnityGfxRendererVulkan ? "vulkan" : threaded ? "threaded" : "render thread";
+	std::printf("%d frames, %d windows, %s: %.3f ms per frame\n", frameCount, windowCount, mode, seconds * 1000.0 / frameCount);
+
+	StopMockUnity();
+	return result;
+}
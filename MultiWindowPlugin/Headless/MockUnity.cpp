@@ -0,0 +1,341 @@
+#include "MockUnity.h"
+#include "VulkanHost.h"
+#include <GL/glew.h>
+#include <SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+extern "C" void UNITY_INTERFACE_API UnityPluginLoad(IUnityInterfaces* unityInterfaces);
+extern "C" void UNITY_INTERFACE_API UnityPluginUnload();
+
+struct HostWindow
+{
+	WindowHandle handle;
+	void* nativeTexture;
+	GLuint texture;
+	GLuint framebuffer;
+	int width;
+	int height;
+};
+
+static IUnityGraphicsDeviceEventCallback _deviceEventCallback = nullptr;
+static std::vector<HostWindow> _hostWindows;
+static std::vector<WindowHandle> _windowHandles;
+static UnityGfxRenderer _renderer = kUnityGfxRendererNull;
+static SDL_Window* _pUnityWindow = nullptr;
+static SDL_GLContext _unityContext = nullptr;
+
+static UnityGfxRenderer UNITY_INTERFACE_API GetRenderer()
+{
+	return _renderer;
+}
+
+static void UNITY_INTERFACE_API RegisterDeviceEventCallback(IUnityGraphicsDeviceEventCallback callback)
+{
+	_deviceEventCallback = callback;
+}
+
+static void UNITY_INTERFACE_API UnregisterDeviceEventCallback(IUnityGraphicsDeviceEventCallback callback)
+{
+	if (_deviceEventCallback == callback)
+	{
+		_deviceEventCallback = nullptr;
+	}
+}
+
+static int UNITY_INTERFACE_API ReserveEventIDRange(int /*count*/)
+{
+	return 0;
+}
+
+static IUnityGraphics _graphics;
+
+static IUnityInterface* UNITY_INTERFACE_API GetInterface(UnityInterfaceGUID guid)
+{
+	if (guid == GetUnityInterfaceGUID<IUnityGraphics>())
+	{
+		return &_graphics;
+	}
+
+#ifdef WINDOW_PLUGIN_VULKAN
+	if (guid == GetUnityInterfaceGUID<IUnityGraphicsVulkan>() && _renderer == kUnityGfxRendererVulkan)
+	{
+		return GetVulkanHostInterface();
+	}
+#endif
+
+	return nullptr;
+}
+
+static IUnityInterface* UNITY_INTERFACE_API GetInterfaceSplit(unsigned long long guidHigh, unsigned long long guidLow)
+{
+	return GetInterface(UnityInterfaceGUID(guidHigh, guidLow));
+}
+
+static void UNITY_INTERFACE_API RegisterInterface(UnityInterfaceGUID /*guid*/, IUnityInterface* /*pInterface*/)
+{
+}
+
+static void UNITY_INTERFACE_API RegisterInterfaceSplit(unsigned long long /*guidHigh*/, unsigned long long /*guidLow*/, IUnityInterface* /*pInterface*/)
+{
+}
+
+static IUnityInterfaces _interfaces = { GetInterface, RegisterInterface, GetInterfaceSplit, RegisterInterfaceSplit };
+
+static void CreateTexture(HostWindow& window, int width, int height)
+{
+	window.width = width;
+	window.height = height;
+
+	if (_renderer == kUnityGfxRendererVulkan)
+	{
+		DestroyVulkanHostTexture(window.nativeTexture);
+		window.nativeTexture = CreateVulkanHostTexture(width, height);
+		return;
+	}
+
+	glDeleteFramebuffers(1, &window.framebuffer);
+	glDeleteTextures(1, &window.texture);
+
+	glGenTextures(1, &window.texture);
+	glBindTexture(GL_TEXTURE_2D, window.texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &window.framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, window.framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, window.texture, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	window.nativeTexture = reinterpret_cast<void*>(uintptr_t(window.texture));
+}
+
+static void UNITY_INTERFACE_API MessageCallback(const char* message)
+{
+	std::printf("%s\n", message);
+}
+
+// The host is single threaded, so Unity's context is current here just as it is on Unity's render thread.
+static void Resize(WindowHandle handle, int width, int height)
+{
+	for (auto it = _hostWindows.begin(); it != _hostWindows.end(); ++it)
+	{
+		if (it->handle == handle)
+		{
+			CreateTexture(*it, width, height);
+			SetWindowTexture(handle, it->nativeTexture, width, height);
+			return;
+		}
+	}
+}
+
+static bool CreateUnityContext(SDL_Window*& pWindow, SDL_GLContext& context)
+{
+	// Unity asks for the newest core profile available, llvmpipe offers 4.5 on current Mesa.
+	const int versions[][2] = { { 4, 5 }, { 3, 3 } };
+	for (auto& version : versions)
+	{
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, version[0]);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, version[1]);
+
+		pWindow = SDL_CreateWindow("Unity", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+		if (pWindow == nullptr)
+		{
+			return false;
+		}
+
+		context = SDL_GL_CreateContext(pWindow);
+		if (context != nullptr)
+		{
+			return true;
+		}
+
+		SDL_DestroyWindow(pWindow);
+	}
+
+	return false;
+}
+
+static bool CreateUnityDevice(SDL_Window*& pWindow, SDL_GLContext& context)
+{
+	if (_renderer == kUnityGfxRendererVulkan)
+	{
+		pWindow = SDL_CreateWindow("Unity", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, SDL_WINDOW_VULKAN | SDL_WINDOW_HIDDEN);
+		return pWindow != nullptr && CreateVulkanHost(pWindow);
+	}
+
+	if (!CreateUnityContext(pWindow, context))
+	{
+		return false;
+	}
+
+	glewExperimental = GL_TRUE;
+	glewInit();
+	std::printf("Renderer: %s, OpenGL %s, SDL video driver: %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION), SDL_GetCurrentVideoDriver());
+	return true;
+}
+
+bool StartMockUnity(UnityGfxRenderer renderer)
+{
+	_renderer = renderer;
+	if (SDL_Init(SDL_INIT_VIDEO) < 0)
+	{
+		std::printf("SDL could not initialise: %s\n", SDL_GetError());
+		return false;
+	}
+
+	if (!CreateUnityDevice(_pUnityWindow, _unityContext))
+	{
+		std::printf("Could not create %s: %s\n", renderer == kUnityGfxRendererVulkan ? "a Vulkan device" : "a core profile context", SDL_GetError());
+		return false;
+	}
+
+	_graphics.GetRenderer = GetRenderer;
+	_graphics.RegisterDeviceEventCallback = RegisterDeviceEventCallback;
+	_graphics.UnregisterDeviceEventCallback = UnregisterDeviceEventCallback;
+	_graphics.ReserveEventIDRange = ReserveEventIDRange;
+
+	UnityPluginLoad(&_interfaces);
+	InitPlugin(MessageCallback);
+	_deviceEventCallback(kUnityGfxDeviceEventInitialize);
+	return true;
+}
+
+WindowHandle CreateMockWindow(const char* title, int width, int height)
+{
+	HostWindow window = HostWindow();
+	CreateTexture(window, width, height);
+	window.handle = CreateNewWindow(title, width, height, 1.0f, true, window.nativeTexture);
+	if (window.handle == 0)
+	{
+		if (_renderer == kUnityGfxRendererVulkan)
+		{
+			DestroyVulkanHostTexture(window.nativeTexture);
+		}
+		else
+		{
+			glDeleteFramebuffers(1, &window.framebuffer);
+			glDeleteTextures(1, &window.texture);
+		}
+		return 0;
+	}
+
+	_hostWindows.push_back(window);
+	_windowHandles.push_back(window.handle);
+	return window.handle;
+}
+
+void UpdateMockWindows()
+{
+	WindowEvent events[64];
+	const int count = UpdateWindows(events, 64);
+	for (int i = 0; i < count; ++i)
+	{
+		if (events[i].type == WindowEventResize)
+		{
+			Resize(events[i].window, events[i].x, events[i].y);
+		}
+	}
+}
+
+const std::vector<WindowHandle>& GetMockWindows()
+{
+	return _windowHandles;
+}
+
+void RenderMockFrame(int frame)
+{
+	const float red = float(frame % 60) / 60.0f;
+	if (_renderer == kUnityGfxRendererVulkan)
+	{
+		ClearVulkanHostTextures(red);
+		return;
+	}
+
+	// A background that changes colour every frame and a square sweeping across it, so presents never see the same pixels.
+	for (auto it = _hostWindows.begin(); it != _hostWindows.end(); ++it)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, it->framebuffer);
+		glViewport(0, 0, it->width, it->height);
+		glClearColor(red, 0.5f, 0.25f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		const int size = std::max(it->height / 4, 1);
+		glEnable(GL_SCISSOR_TEST);
+		glScissor((frame * 8) % std::max(it->width - size, 1), (it->height - size) / 2, size, size);
+		glClearColor(1.0f - red, 1.0f, 1.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glDisable(GL_SCISSOR_TEST);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void EndMockFrame()
+{
+	if (_renderer == kUnityGfxRendererVulkan)
+	{
+		EndVulkanHostFrame();
+	}
+}
+
+void FinishMockFrame()
+{
+	// The Vulkan host already waits for the queue when it submits.
+	if (_renderer != kUnityGfxRendererVulkan)
+	{
+		glFinish();
+	}
+}
+
+bool CheckMockDevice()
+{
+	if (_renderer == kUnityGfxRendererVulkan)
+	{
+		return true;
+	}
+
+	const GLenum error = glGetError();
+	if (error != GL_NO_ERROR)
+	{
+		std::printf("OpenGL error 0x%04x\n", error);
+		return false;
+	}
+
+	return true;
+}
+
+void StopMockUnity()
+{
+	_deviceEventCallback(kUnityGfxDeviceEventShutdown);
+	for (auto it = _hostWindows.begin(); it != _hostWindows.end(); ++it)
+	{
+		DisposeWindow(it->handle);
+		if (_renderer != kUnityGfxRendererVulkan)
+		{
+			glDeleteFramebuffers(1, &it->framebuffer);
+			glDeleteTextures(1, &it->texture);
+		}
+	}
+	_hostWindows.clear();
+	_windowHandles.clear();
+
+	// In the order Unity calls them. The plugin's event pump thread owns SDL's video subsystem until ShutdownPlugin
+	// stops it, so the host only tears down its own window and SDL afterwards.
+	ShutdownPlugin();
+	UnityPluginUnload();
+
+	if (_renderer == kUnityGfxRendererVulkan)
+	{
+		DestroyVulkanHost();
+	}
+	else
+	{
+		SDL_GL_DeleteContext(_unityContext);
+	}
+	SDL_DestroyWindow(_pUnityWindow);
+	_pUnityWindow = nullptr;
+	_unityContext = nullptr;
+	SDL_Quit();
+}
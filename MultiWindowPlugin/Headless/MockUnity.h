@@ -0,0 +1,25 @@
+#pragma once
+
+#include "UnityInterface.h"
+#include "IUnityGraphics.h"
+#include "WindowEvents.h"
+#include <vector>
+
+// Stands in for Unity on Linux: owns the GL context or Vulkan device Unity would, loads the plugin through mock
+// interfaces and renders into the window textures the way cameras do. Shared by HeadlessHost and Benchmark.
+bool StartMockUnity(UnityGfxRenderer renderer);
+// Like WindowManager.CreateWindow, with a texture of the window's size. Returns 0 if the plugin failed.
+WindowHandle CreateMockWindow(const char* title, int width, int height);
+// Like WindowManager.Update: calls UpdateWindows and answers resize events with a new texture.
+void UpdateMockWindows();
+const std::vector<WindowHandle>& GetMockWindows();
+// Stands in for Unity's cameras, animating every texture so that no two frames are the same.
+void RenderMockFrame(int frame);
+// Submits whatever the plugin left recorded, as Unity does at the end of a frame.
+void EndMockFrame();
+// Waits until the GPU has finished everything submitted from Unity's device.
+void FinishMockFrame();
+// Returns false and prints the error if the device reported one.
+bool CheckMockDevice();
+// Same order as Unity: the device goes away first, then managed code disposes the windows and shuts the plugin down.
+void StopMockUnity();
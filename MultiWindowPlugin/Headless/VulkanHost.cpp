@@ -0,0 +1,435 @@
+#include "VulkanHost.h"
+#ifdef WINDOW_PLUGIN_VULKAN
+#include "SDL_vulkan.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+struct HostTexture
+{
+	VkImage image;
+	VkDeviceMemory memory;
+	VkImageLayout layout;
+	VkExtent3D extent;
+};
+
+static const VkFormat TextureFormat = VK_FORMAT_R8G8B8A8_UNORM;
+static const VkImageUsageFlags TextureUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+static UnityVulkanInstance _instance;
+static IUnityGraphicsVulkan _vulkan;
+static VkCommandPool _commandPool = VK_NULL_HANDLE;
+static VkCommandBuffer _commandBuffer = VK_NULL_HANDLE;
+static bool _recording = false;
+static std::vector<HostTexture*> _textures;
+
+static void BeginCommands()
+{
+	if (_recording)
+	{
+		return;
+	}
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(_commandBuffer, &beginInfo);
+	_recording = true;
+}
+
+// The host waits for every submission, so its single command buffer can be recorded again straight away.
+static void SubmitCommands()
+{
+	if (!_recording)
+	{
+		return;
+	}
+
+	vkEndCommandBuffer(_commandBuffer);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &_commandBuffer;
+	vkQueueSubmit(_instance.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(_instance.graphicsQueue);
+	_recording = false;
+}
+
+static void Transition(HostTexture& texture, VkImageLayout layout, VkPipelineStageFlags stage, VkAccessFlags access)
+{
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = access;
+	barrier.oldLayout = texture.layout;
+	barrier.newLayout = layout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = texture.image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	texture.layout = layout;
+}
+
+static HostTexture* FindTexture(void* nativeTexture)
+{
+	for (auto it = _textures.begin(); it != _textures.end(); ++it)
+	{
+		if (&(*it)->image == nativeTexture)
+		{
+			return *it;
+		}
+	}
+
+	return nullptr;
+}
+
+static bool UNITY_INTERFACE_API InterceptInitialization(UnityVulkanInitCallback /*func*/, void* /*userdata*/)
+{
+	return false;
+}
+
+static PFN_vkVoidFunction UNITY_INTERFACE_API InterceptVulkanAPI(const char* /*name*/, PFN_vkVoidFunction /*func*/)
+{
+	return nullptr;
+}
+
+static void UNITY_INTERFACE_API ConfigureEvent(int /*eventID*/, const UnityVulkanPluginEventConfig* /*pluginEventConfig*/)
+{
+}
+
+static UnityVulkanInstance UNITY_INTERFACE_API Instance()
+{
+	return _instance;
+}
+
+static bool UNITY_INTERFACE_API CommandRecordingState(UnityVulkanRecordingState* outCommandRecordingState, UnityVulkanGraphicsQueueAccess /*queueAccess*/)
+{
+	BeginCommands();
+	*outCommandRecordingState = UnityVulkanRecordingState();
+	outCommandRecordingState->commandBuffer = _commandBuffer;
+	outCommandRecordingState->commandBufferLevel = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	outCommandRecordingState->subPassIndex = -1;
+	return true;
+}
+
+// Like Unity, records the transition into the frame's command buffer rather than submitting it.
+static bool UNITY_INTERFACE_API AccessTexture(void* nativeTexture, const VkImageSubresource* /*subResource*/, VkImageLayout layout,
+	VkPipelineStageFlags pipelineStageFlags, VkAccessFlags accessFlags, UnityVulkanResourceAccessMode accessMode, UnityVulkanImage* outImage)
+{
+	HostTexture* pTexture = FindTexture(nativeTexture);
+	if (pTexture == nullptr)
+	{
+		return false;
+	}
+
+	if (accessMode == kUnityVulkanResourceAccess_PipelineBarrier)
+	{
+		BeginCommands();
+		Transition(*pTexture, layout, pipelineStageFlags, accessFlags);
+	}
+
+	*outImage = UnityVulkanImage();
+	outImage->image = pTexture->image;
+	outImage->layout = pTexture->layout;
+	outImage->aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+	outImage->usage = TextureUsage;
+	outImage->format = TextureFormat;
+	outImage->extent = pTexture->extent;
+	outImage->tiling = VK_IMAGE_TILING_OPTIMAL;
+	outImage->type = VK_IMAGE_TYPE_2D;
+	outImage->samples = VK_SAMPLE_COUNT_1_BIT;
+	outImage->layers = 1;
+	outImage->mipCount = 1;
+	return true;
+}
+
+static bool UNITY_INTERFACE_API AccessRenderBufferTexture(UnityRenderBuffer /*nativeRenderBuffer*/, const VkImageSubresource* /*subResource*/, VkImageLayout /*layout*/,
+	VkPipelineStageFlags /*pipelineStageFlags*/, VkAccessFlags /*accessFlags*/, UnityVulkanResourceAccessMode /*accessMode*/, UnityVulkanImage* /*outImage*/)
+{
+	return false;
+}
+
+static bool UNITY_INTERFACE_API AccessBuffer(void* /*nativeBuffer*/, VkPipelineStageFlags /*pipelineStageFlags*/, VkAccessFlags /*accessFlags*/, UnityVulkanResourceAccessMode /*accessMode*/, UnityVulkanBuffer* /*outBuffer*/)
+{
+	return false;
+}
+
+static void UNITY_INTERFACE_API EnsureRenderPass()
+{
+}
+
+// Always synchronous, which is one of the two behaviours Unity allows.
+static void UNITY_INTERFACE_API AccessQueue(UnityRenderingEventAndData callback, int eventId, void* userData, bool flush)
+{
+	if (flush)
+	{
+		SubmitCommands();
+	}
+
+	callback(eventId, userData);
+}
+
+static bool UNITY_INTERFACE_API ConfigureSwapchain(const UnityVulkanSwapchainConfiguration* /*swapChainConfig*/)
+{
+	return false;
+}
+
+static bool UNITY_INTERFACE_API AccessTextureByID(UnityTextureID /*textureID*/, const VkImageSubresource* /*subResource*/, VkImageLayout /*layout*/,
+	VkPipelineStageFlags /*pipelineStageFlags*/, VkAccessFlags /*accessFlags*/, UnityVulkanResourceAccessMode /*accessMode*/, UnityVulkanImage* /*outImage*/)
+{
+	return false;
+}
+
+bool CreateVulkanHost(SDL_Window* pWindow)
+{
+	// Unity enables the surface extensions for its own window, SDL knows which ones the platform needs.
+	unsigned int extensionCount = 0;
+	SDL_Vulkan_GetInstanceExtensions(pWindow, &extensionCount, nullptr);
+	std::vector<const char*> extensions(extensionCount);
+	SDL_Vulkan_GetInstanceExtensions(pWindow, &extensionCount, extensions.data());
+
+	VkApplicationInfo applicationInfo = {};
+	applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	applicationInfo.pApplicationName = "HeadlessHost";
+	applicationInfo.apiVersion = VK_API_VERSION_1_0;
+
+	VkInstanceCreateInfo instanceInfo = {};
+	instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instanceInfo.pApplicationInfo = &applicationInfo;
+	instanceInfo.enabledExtensionCount = extensionCount;
+	instanceInfo.ppEnabledExtensionNames = extensions.data();
+
+	_instance = UnityVulkanInstance();
+	if (vkCreateInstance(&instanceInfo, nullptr, &_instance.instance) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	uint32_t physicalDeviceCount = 1;
+	if (vkEnumeratePhysicalDevices(_instance.instance, &physicalDeviceCount, &_instance.physicalDevice) < 0 || physicalDeviceCount == 0)
+	{
+		return false;
+	}
+
+	uint32_t familyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(_instance.physicalDevice, &familyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> families(familyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(_instance.physicalDevice, &familyCount, families.data());
+	const auto graphicsFamily = std::find_if(families.begin(), families.end(), [](const VkQueueFamilyProperties& family) { return (family.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0; });
+	if (graphicsFamily == families.end())
+	{
+		return false;
+	}
+	_instance.queueFamilyIndex = unsigned(graphicsFamily - families.begin());
+
+	const float priority = 1.0f;
+	VkDeviceQueueCreateInfo queueInfo = {};
+	queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queueInfo.queueFamilyIndex = _instance.queueFamilyIndex;
+	queueInfo.queueCount = 1;
+	queueInfo.pQueuePriorities = &priority;
+
+	const char* deviceExtensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	VkDeviceCreateInfo deviceInfo = {};
+	deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceInfo.queueCreateInfoCount = 1;
+	deviceInfo.pQueueCreateInfos = &queueInfo;
+	deviceInfo.enabledExtensionCount = 1;
+	deviceInfo.ppEnabledExtensionNames = deviceExtensions;
+	if (vkCreateDevice(_instance.physicalDevice, &deviceInfo, nullptr, &_instance.device) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	vkGetDeviceQueue(_instance.device, _instance.queueFamilyIndex, 0, &_instance.graphicsQueue);
+	_instance.getInstanceProcAddr = vkGetInstanceProcAddr;
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = _instance.queueFamilyIndex;
+	vkCreateCommandPool(_instance.device, &poolInfo, nullptr, &_commandPool);
+
+	VkCommandBufferAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool = _commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	vkAllocateCommandBuffers(_instance.device, &allocateInfo, &_commandBuffer);
+
+	_vulkan.InterceptInitialization = InterceptInitialization;
+	_vulkan.InterceptVulkanAPI = InterceptVulkanAPI;
+	_vulkan.ConfigureEvent = ConfigureEvent;
+	_vulkan.Instance = Instance;
+	_vulkan.CommandRecordingState = CommandRecordingState;
+	_vulkan.AccessTexture = AccessTexture;
+	_vulkan.AccessRenderBufferTexture = AccessRenderBufferTexture;
+	_vulkan.AccessRenderBufferResolveTexture = AccessRenderBufferTexture;
+	_vulkan.AccessBuffer = AccessBuffer;
+	_vulkan.EnsureOutsideRenderPass = EnsureRenderPass;
+	_vulkan.EnsureInsideRenderPass = EnsureRenderPass;
+	_vulkan.AccessQueue = AccessQueue;
+	_vulkan.ConfigureSwapchain = ConfigureSwapchain;
+	_vulkan.AccessTextureByID = AccessTextureByID;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(_instance.physicalDevice, &properties);
+	std::printf("Renderer: %s, Vulkan, SDL video driver: %s\n", properties.deviceName, SDL_GetCurrentVideoDriver());
+	return true;
+}
+
+IUnityGraphicsVulkan* GetVulkanHostInterface()
+{
+	return &_vulkan;
+}
+
+void* CreateVulkanHostTexture(int width, int height)
+{
+	HostTexture* pTexture = new HostTexture();
+	pTexture->layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	pTexture->extent.width = uint32_t(width);
+	pTexture->extent.height = uint32_t(height);
+	pTexture->extent.depth = 1;
+
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = TextureFormat;
+	imageInfo.extent = pTexture->extent;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = TextureUsage;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	vkCreateImage(_instance.device, &imageInfo, nullptr, &pTexture->image);
+
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(_instance.device, pTexture->image, &requirements);
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(_instance.physicalDevice, &memoryProperties);
+
+	uint32_t memoryType = 0;
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+	{
+		if (requirements.memoryTypeBits & (1u << i))
+		{
+			memoryType = i;
+			if (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+			{
+				break;
+			}
+		}
+	}
+
+	VkMemoryAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = requirements.size;
+	allocateInfo.memoryTypeIndex = memoryType;
+	vkAllocateMemory(_instance.device, &allocateInfo, nullptr, &pTexture->memory);
+	vkBindImageMemory(_instance.device, pTexture->image, pTexture->memory, 0);
+
+	_textures.push_back(pTexture);
+	return &pTexture->image;
+}
+
+void DestroyVulkanHostTexture(void* nativeTexture)
+{
+	HostTexture* pTexture = FindTexture(nativeTexture);
+	if (pTexture == nullptr)
+	{
+		return;
+	}
+
+	// Unity keeps released textures alive until the GPU is done with them, the host simply waits.
+	SubmitCommands();
+	vkDeviceWaitIdle(_instance.device);
+	vkDestroyImage(_instance.device, pTexture->image, nullptr);
+	vkFreeMemory(_instance.device, pTexture->memory, nullptr);
+	_textures.erase(std::find(_textures.begin(), _textures.end(), pTexture));
+	delete pTexture;
+}
+
+void ClearVulkanHostTextures(float red)
+{
+	BeginCommands();
+
+	VkClearColorValue color = {};
+	color.float32[0] = red;
+	color.float32[1] = 0.5f;
+	color.float32[2] = 0.25f;
+	color.float32[3] = 1.0f;
+
+	VkImageSubresourceRange range = {};
+	range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	range.levelCount = 1;
+	range.layerCount = 1;
+
+	for (auto it = _textures.begin(); it != _textures.end(); ++it)
+	{
+		HostTexture& texture = **it;
+		Transition(texture, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+		vkCmdClearColorImage(_commandBuffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &color, 1, &range);
+	}
+}
+
+void EndVulkanHostFrame()
+{
+	SubmitCommands();
+}
+
+void DestroyVulkanHost()
+{
+	if (_instance.device != VK_NULL_HANDLE)
+	{
+		SubmitCommands();
+		vkDeviceWaitIdle(_instance.device);
+		while (!_textures.empty())
+		{
+			DestroyVulkanHostTexture(&_textures.back()->image);
+		}
+
+		vkDestroyCommandPool(_instance.device, _commandPool, nullptr);
+		vkDestroyDevice(_instance.device, nullptr);
+	}
+
+	if (_instance.instance != VK_NULL_HANDLE)
+	{
+		vkDestroyInstance(_instance.instance, nullptr);
+	}
+
+	_instance = UnityVulkanInstance();
+}
+#else
+bool CreateVulkanHost(SDL_Window* /*pWindow*/)
+{
+	SDL_SetError("the plugin was built without WINDOW_PLUGIN_VULKAN");
+	return false;
+}
+
+void* CreateVulkanHostTexture(int /*width*/, int /*height*/)
+{
+	return nullptr;
+}
+
+void DestroyVulkanHostTexture(void* /*nativeTexture*/)
+{
+}
+
+void ClearVulkanHostTextures(float /*red*/)
+{
+}
+
+void EndVulkanHostFrame()
+{
+}
+
+void DestroyVulkanHost()
+{
+}
+#endif
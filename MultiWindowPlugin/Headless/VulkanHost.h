@@ -0,0 +1,22 @@
+#pragma once
+
+#include "IUnityGraphics.h"
+#ifdef WINDOW_PLUGIN_VULKAN
+#include "IUnityGraphicsVulkan.h"
+#endif
+#include <SDL.h>
+
+// The Vulkan device and IUnityGraphicsVulkan that Unity would own, so the plugin's Vulkan backend runs on lavapipe.
+// Texture pointers point at a VkImage, as Texture.GetNativeTexturePtr does on Vulkan.
+// Without WINDOW_PLUGIN_VULKAN the host cannot be created and --vulkan fails at startup.
+bool CreateVulkanHost(SDL_Window* pWindow);
+#ifdef WINDOW_PLUGIN_VULKAN
+IUnityGraphicsVulkan* GetVulkanHostInterface();
+#endif
+void* CreateVulkanHostTexture(int width, int height);
+void DestroyVulkanHostTexture(void* nativeTexture);
+// Stands in for Unity's cameras, recording a clear of every texture into the frame's command buffer.
+void ClearVulkanHostTextures(float red);
+// Submits whatever is still recorded and waits for the queue, as Unity does at the end of a frame.
+void EndVulkanHostFrame();
+void DestroyVulkanHost();
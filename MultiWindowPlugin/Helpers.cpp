@@ -1,7 +1,6 @@
 #include "Helpers.h"
 #include "UnityInterface.h"
-#include <sstream>
-#include <GL/glew.h>
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 
@@ -18,24 +17,4 @@ std::string GetLastErrorAsString(unsigned long errorMessageID)
 
 	return message;
 }
-
-void ErrorCheck(const std::string& event)
-{
-	GLenum err;
-	while ((err = glGetError()) != 0) {
-		std::stringstream ss;
-		ss << "OpenGL Error: ";
-		ss << event;
-		ss << " - ";
-		ss << err;
-		Log(ss.str());
-	}
-	   
-	const DWORD t = GetLastError();
-	if (t != 0)
-	{
-		std::stringstream ss;
-		ss << "Error: " << t << " - " << GetLastErrorAsString(t);
-		Log(ss.str());
-	}
-}
\ No newline at end of file
+#endif
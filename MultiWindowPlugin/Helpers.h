@@ -2,5 +2,6 @@
 
 #include <string>
 
+#ifdef _WIN32
 std::string GetLastErrorAsString(unsigned long errorMessageID);
-void ErrorCheck(const std::string& event);
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "PresentScheduler.h"
+#include "Window.h"
+#include <algorithm>
+
+PresentScheduler::PresentScheduler()
+	: _budgetMicroseconds(0)
+	, _lastFrame()
+	, _candidates()
+{
+}
+
+void PresentScheduler::SetBudget(unsigned int microseconds)
+{
+	_budgetMicroseconds = microseconds;
+}
+
+void PresentScheduler::Schedule(const WindowRegistry& windows)
+{
+	// Frames rarely land exactly on a window's period, a window due within half a frame presents now rather than a frame late.
+	const auto now = std::chrono::steady_clock::now();
+	const auto horizon = _lastFrame == std::chrono::steady_clock::time_point() ? now : now + (now - _lastFrame) / 2;
+	_lastFrame = now;
+
+	_candidates.clear();
+	for (Window* pWindow : windows)
+	{
+		std::chrono::steady_clock::time_point due;
+		if (!pWindow->IsPresentDue(horizon, due))
+		{
+			pWindow->SetSchedule(PresentNotDue, now);
+			continue;
+		}
+
+		Candidate candidate = { pWindow, pWindow->IsFocused(), due, pWindow->GetPresentCost() };
+		_candidates.push_back(candidate);
+	}
+
+	if (_budgetMicroseconds != 0)
+	{
+		std::sort(_candidates.begin(), _candidates.end(), [](const Candidate& a, const Candidate& b)
+		{
+			return a.focused != b.focused ? a.focused : a.due < b.due;
+		});
+	}
+
+	float spentMicroseconds = 0.0f;
+	for (size_t i = 0; i < _candidates.size(); ++i)
+	{
+		const Candidate& candidate = _candidates[i];
+		if (_budgetMicroseconds != 0 && i != 0 && spentMicroseconds + candidate.cost > _budgetMicroseconds)
+		{
+			candidate.pWindow->SetSchedule(PresentDeferred, now);
+			continue;
+		}
+
+		spentMicroseconds += candidate.cost;
+		candidate.pWindow->SetSchedule(PresentScheduled, now);
+	}
+}
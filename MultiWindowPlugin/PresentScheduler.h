@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include "WindowRegistry.h"
+
+// What the scheduler decided for a window this frame, mirrored in ExternalWindow.cs.
+enum PresentSchedule : int
+{
+	PresentScheduled = 0,
+	// Hidden, or its target rate's next slot has not come yet.
+	PresentNotDue = 1,
+	// Due, but left out to keep the frame within the present budget. It is ahead of the windows that did present next frame.
+	PresentDeferred = 2
+};
+
+// Decides on the main thread, once per frame in UpdateWindows, which windows the next present event presents.
+// Windows with a target rate are due once per period, each at a phase of its own so low rates spread over frames.
+// With a budget, due windows are admitted focused first and then longest due first, for as long as their estimated
+// present cost fits. The first window is always admitted, a budget smaller than one present cannot starve every window.
+class PresentScheduler
+{
+public:
+	PresentScheduler();
+
+	// Zero presents every due window.
+	void SetBudget(unsigned int microseconds);
+	void Schedule(const WindowRegistry& windows);
+
+private:
+	struct Candidate
+	{
+		Window* pWindow;
+		bool focused;
+		std::chrono::steady_clock::time_point due;
+		float cost;
+	};
+
+	unsigned int _budgetMicroseconds;
+	std::chrono::steady_clock::time_point _lastFrame;
+	// Kept across frames so scheduling does not allocate.
+	std::vector<Candidate> _candidates;
+};
@@ -0,0 +1,97 @@
+#include "PresentStats.h"
+#include <algorithm>
+#include <cmath>
+
+// Weight of a new sample in the moving averages, a present's cost settles within a few dozen frames.
+static const float AverageWeight = 0.1f;
+
+static float Milliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+PresentStats::PresentStats()
+	: _presentCpu()
+	, _swap()
+	, _textureToSwap()
+	, _gpu()
+	, _eventLatency()
+	, _averageDraw(0.0f)
+	, _averageGpu(0.0f)
+{
+}
+
+void PresentStats::Record(std::chrono::steady_clock::time_point presentStart, std::chrono::steady_clock::time_point swapStart,
+	std::chrono::steady_clock::time_point textureReady)
+{
+	const auto swapEnd = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_presentCpu.Add(Milliseconds(presentStart, swapEnd));
+	_swap.Add(Milliseconds(swapStart, swapEnd));
+	_averageDraw = _averageDraw + (Milliseconds(presentStart, swapStart) - _averageDraw) * AverageWeight;
+	if (textureReady != std::chrono::steady_clock::time_point())
+	{
+		_textureToSwap.Add(Milliseconds(textureReady, swapEnd));
+	}
+}
+
+void PresentStats::RecordGpu(float milliseconds)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_gpu.Add(milliseconds);
+	_averageGpu = _averageGpu + (milliseconds - _averageGpu) * AverageWeight;
+}
+
+void PresentStats::RecordEventLatency(std::chrono::steady_clock::time_point received, std::chrono::steady_clock::time_point applied)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_eventLatency.Add(Milliseconds(received, applied));
+}
+
+void PresentStats::Get(WindowStats& stats) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_presentCpu.Get(stats.presentCpu);
+	_swap.Get(stats.swap);
+	_textureToSwap.Get(stats.textureToSwap);
+	_gpu.Get(stats.gpu);
+	_eventLatency.Get(stats.eventLatency);
+}
+
+float PresentStats::GetAverageCost() const
+{
+	return (_averageDraw + _averageGpu) * 1000.0f;
+}
+
+void PresentStats::Samples::Add(float milliseconds)
+{
+	values[next] = milliseconds;
+	next = (next + 1) % SampleCount;
+	count = std::min(count + 1, SampleCount);
+}
+
+// Nearest rank, like the benchmark, so every reported value is one that was actually measured.
+void PresentStats::Samples::Get(FrameTimeStats& stats) const
+{
+	if (count == 0)
+	{
+		stats = FrameTimeStats();
+		return;
+	}
+
+	float sorted[SampleCount];
+	std::copy(values, values + count, sorted);
+	std::sort(sorted, sorted + count);
+
+	const auto percentile = [&sorted, this](float percentile)
+	{
+		const int rank = int(std::ceil(percentile / 100.0f * count));
+		return sorted[std::min(std::max(rank, 1), count) - 1];
+	};
+
+	stats.last = values[(next + SampleCount - 1) % SampleCount];
+	stats.p50 = percentile(50.0f);
+	stats.p95 = percentile(95.0f);
+	stats.p99 = percentile(99.0f);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include "WindowRegistry.h"
+
+// Blittable, mirrored in WindowManager.cs. Milliseconds over the last PresentStats::SampleCount presents.
+struct FrameTimeStats
+{
+	float last;
+	float p50;
+	float p95;
+	float p99;
+};
+
+// Blittable, mirrored in WindowManager.cs.
+struct WindowStats
+{
+	WindowHandle window;
+	unsigned int presented;
+	// Presents left out by dirty tracking because the frame had not changed.
+	unsigned int skipped;
+	// Frames the window was due but left out to stay within the present budget.
+	unsigned int deferred;
+	// Time the presenting thread spent on the window, including the swap.
+	FrameTimeStats presentCpu;
+	FrameTimeStats swap;
+	// From the present event Unity issued once its frame was rendered to the window's swap returning, the age of what is on screen.
+	FrameTimeStats textureToSwap;
+	// GPU time of the window's draw or blit, only measured while GPU timing is enabled.
+	FrameTimeStats gpu;
+	// From the event pump thread receiving an event to UpdateWindows applying it, over the last SampleCount events.
+	FrameTimeStats eventLatency;
+	// Events the window's queue had no room for, mostly mouse motion while Unity's frame took long.
+	unsigned int droppedEvents;
+};
+
+// Rolling present timings of one window and how long its events waited. Present timings are recorded on whichever
+// thread presents the window, event latency on the main thread. Everything is read on the main thread.
+class PresentStats
+{
+public:
+	static const int SampleCount = 120;
+
+	PresentStats();
+
+	// Continuous presents re-show an old frame, they pass a default time point so the latency is not recorded.
+	void Record(std::chrono::steady_clock::time_point presentStart, std::chrono::steady_clock::time_point swapStart,
+		std::chrono::steady_clock::time_point textureReady);
+	// Arrives frames after the present it belongs to, once the timer query is available.
+	void RecordGpu(float milliseconds);
+	void RecordEventLatency(std::chrono::steady_clock::time_point received, std::chrono::steady_clock::time_point applied);
+	void Get(WindowStats& stats) const;
+	// Microseconds a present is expected to cost, the draw up to the swap plus its GPU time while that is measured.
+	// Moving averages, read by the scheduler without taking the lock.
+	float GetAverageCost() const;
+
+private:
+	struct Samples
+	{
+		float values[SampleCount];
+		int count;
+		int next;
+
+		void Add(float milliseconds);
+		void Get(FrameTimeStats& stats) const;
+	};
+
+	mutable std::mutex _mutex;
+	Samples _presentCpu;
+	Samples _swap;
+	Samples _textureToSwap;
+	Samples _gpu;
+	Samples _eventLatency;
+	std::atomic<float> _averageDraw;
+	std::atomic<float> _averageGpu;
+};
@@ -0,0 +1,320 @@
+#include "UnityInterface.h"
+#include "Presenter.h"
+#include "Window.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "GLDiagnostics.h"
+#include <chrono>
+#include <algorithm>
+
+Presenter::Presenter(GLPlatform& platform, PlatformDrawable drawable, unsigned int windowId, PresentStats& stats)
+	: _platform(platform)
+	, _drawable(drawable)
+	, _windowId(windowId)
+	, _stats(stats)
+	, _timer(4)
+	, _context(nullptr)
+	, _stopping(false)
+	, _hasFrame(false)
+	, _frame()
+	, _copies()
+	, _heldCopy(-1)
+	, _continuous(false)
+	, _presentMode(PresentModeVsync)
+	, _exposed(false)
+	, _hidden(false)
+	, _width(0)
+	, _height(0)
+	, _upscaleMode(UpscaleBilinear)
+	, _refreshRate(60)
+	, _presentPath(PresentPathNone)
+	, _activePresentMode(PresentModeVsync)
+{
+}
+
+bool Presenter::Start()
+{
+	if (!GLEW_ARB_copy_image)
+	{
+		return false;
+	}
+
+	_context = _platform.CreateSharedContext(_drawable, GLDiagnostics::IsEnabled());
+	if (_context == nullptr)
+	{
+		return false;
+	}
+
+	_thread = std::thread(&Presenter::Run, this);
+	return true;
+}
+
+void Presenter::QueueFrame(GLStateCache& state, const WindowTexture& texture, int width, int height, UpscaleMode upscaleMode, PresentMode presentMode, bool continuous)
+{
+	// Nothing to copy until Unity has handed over a texture, leave the last frame queued as it is.
+	if (texture.handle == 0 || texture.width == 0 || texture.height == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// A slow presenter only ever sees the newest frame, an untaken one is overwritten in place.
+	int index = _heldCopy == 0 ? 1 : 0;
+	if (_hasFrame)
+	{
+		glDeleteSync(_frame.readyFence);
+		index = _frame.copy;
+	}
+
+	// The copy is made here rather than on the presenter so that Unity's next writes to its texture, on this same
+	// context, are ordered after it. The presenter only ever reads its own copies.
+	FrameCopy& copy = _copies[index];
+	if (copy.consumedFence != nullptr)
+	{
+		glWaitSync(copy.consumedFence, 0, GL_TIMEOUT_IGNORED);
+		glDeleteSync(copy.consumedFence);
+		copy.consumedFence = nullptr;
+	}
+	CopyFrame(state, texture, copy);
+
+	_frame.readyFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_frame.copy = index;
+	_frame.texture = texture;
+	_frame.texture.handle = copy.texture;
+	_frame.texture.width = copy.width;
+	_frame.texture.height = copy.height;
+	_frame.width = width;
+	_frame.height = height;
+	_frame.upscaleMode = upscaleMode;
+	_frame.readyTime = std::chrono::steady_clock::now();
+	_hasFrame = true;
+	_continuous = continuous;
+	_presentMode = presentMode;
+
+	// The fence must reach the GPU before another context can wait on it.
+	glFlush();
+	_wake.notify_one();
+}
+
+void Presenter::Expose(int width, int height)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (!_continuous)
+	{
+		return;
+	}
+
+	_width = width;
+	_height = height;
+	_exposed = true;
+	_wake.notify_one();
+}
+
+void Presenter::SetRefreshRate(int refreshRate)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_refreshRate = refreshRate > 0 ? refreshRate : 60;
+}
+
+void Presenter::SetVisible(bool visible)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_hidden = !visible;
+	_exposed = visible;
+	_wake.notify_one();
+}
+
+PresentPath Presenter::GetPresentPath() const
+{
+	return PresentPath(_presentPath.load());
+}
+
+PresentMode Presenter::GetPresentMode() const
+{
+	return PresentMode(_activePresentMode.load());
+}
+
+void Presenter::Run()
+{
+	const UnityProfilerThreadId profilerThread = Profiler::RegisterThread("Window Presenter");
+	_platform.MakeCurrent(_drawable, _context);
+
+	// Vertex array and framebuffer objects are not shared between contexts.
+	const GLuint vao = Window::CreateVertexArray();
+	GLuint readFramebuffer;
+	glGenFramebuffers(1, &readFramebuffer);
+	GLStateCache state(false);
+	WindowTexture lastTexture = {};
+	DiagnosticsContext diagnostics = {};
+	int appliedPresentMode = -1;
+
+	while (true)
+	{
+		Frame frame;
+		bool hasFrame, continuous;
+		int width, height;
+		UpscaleMode upscaleMode;
+		PresentMode presentMode;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			const auto wakeCondition = [this] { return _hasFrame || _exposed || _stopping; };
+			if (_continuous && !_hidden)
+			{
+				_wake.wait_for(lock, std::chrono::microseconds(1000000 / _refreshRate), wakeCondition);
+			}
+			else
+			{
+				_wake.wait(lock, wakeCondition);
+			}
+
+			if (_stopping)
+			{
+				break;
+			}
+
+			hasFrame = _hasFrame;
+			frame = _frame;
+			_hasFrame = false;
+			_exposed = false;
+
+			if (hasFrame)
+			{
+				// Everything read from the previous copy was issued before this point.
+				if (_heldCopy >= 0)
+				{
+					_copies[_heldCopy].consumedFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+					glFlush();
+				}
+				_heldCopy = frame.copy;
+				_width = frame.width;
+				_height = frame.height;
+				_upscaleMode = frame.upscaleMode;
+			}
+
+			continuous = _continuous;
+			width = _width;
+			height = _height;
+			upscaleMode = _upscaleMode;
+			presentMode = _presentMode;
+		}
+
+		if (hasFrame)
+		{
+			glWaitSync(frame.readyFence, 0, GL_TIMEOUT_IGNORED);
+			glDeleteSync(frame.readyFence);
+			lastTexture = frame.texture;
+
+			// Texture names are shared with Unity's context, where they can be deleted and handed out again.
+			state.BeginPass();
+		}
+		else if (!continuous || lastTexture.handle == 0)
+		{
+			continue;
+		}
+		const WindowTexture& texture = lastTexture;
+
+		GLDiagnostics::UpdateContext(diagnostics);
+
+		unsigned long long tag;
+		float gpuMilliseconds;
+		while (_timer.Collect(tag, gpuMilliseconds))
+		{
+			_stats.RecordGpu(gpuMilliseconds);
+		}
+
+		const auto presentStart = std::chrono::steady_clock::now();
+		const bool timed = _timer.Begin(0);
+		const PresentPath presentPath = Window::PresentTexture(state, vao, readFramebuffer, texture, width, height, upscaleMode);
+		if (timed)
+		{
+			_timer.End();
+		}
+		_presentPath = presentPath;
+		{
+			ProfilerScope scope(ProfilerMarkerSwap, _windowId, width, height, presentPath);
+			if (presentMode != appliedPresentMode)
+			{
+				const int swapInterval = _platform.SetSwapInterval(_drawable, Window::GetSwapInterval(presentMode, true));
+				_activePresentMode = Window::GetSwapMode(swapInterval, presentMode, true);
+				appliedPresentMode = presentMode;
+			}
+
+			const auto swapStart = std::chrono::steady_clock::now();
+			_platform.SwapBuffers(_drawable);
+			_stats.Record(presentStart, swapStart, hasFrame ? frame.readyTime : std::chrono::steady_clock::time_point());
+		}
+	}
+
+	if (_hasFrame)
+	{
+		glDeleteSync(_frame.readyFence);
+		_hasFrame = false;
+	}
+
+	// The copies were made on Unity's context, textures and fences are shared with it.
+	for (FrameCopy& copy : _copies)
+	{
+		if (copy.consumedFence != nullptr)
+		{
+			glDeleteSync(copy.consumedFence);
+		}
+		glDeleteTextures(1, &copy.texture);
+		copy = FrameCopy();
+	}
+	_heldCopy = -1;
+
+	glDeleteFramebuffers(1, &readFramebuffer);
+	glDeleteVertexArrays(1, &vao);
+	_timer.Release();
+	GLDiagnostics::ReleaseContext(diagnostics);
+	_platform.ReleaseCurrent();
+	_platform.DestroyContext(_context);
+	_context = nullptr;
+	Profiler::UnregisterThread(profilerThread);
+}
+
+void Presenter::CopyFrame(GLStateCache& state, const WindowTexture& texture, FrameCopy& copy)
+{
+	GLint width, height, format;
+	state.BindTexture(texture.handle);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+
+	if (copy.texture == 0 || width != copy.width || height != copy.height || format != copy.format)
+	{
+		// Deleting a bound texture silently unbinds it, keep the cache in step in case the name is reused.
+		state.BindTexture(0);
+		glDeleteTextures(1, &copy.texture);
+		glGenTextures(1, &copy.texture);
+		state.BindTexture(copy.texture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GLenum(format), width, height);
+		copy.width = width;
+		copy.height = height;
+		copy.format = format;
+	}
+
+	// Only the part Unity rendered to this frame is needed.
+	glCopyImageSubData(texture.handle, GL_TEXTURE_2D, 0, 0, 0, 0, copy.texture, GL_TEXTURE_2D, 0, 0, 0, 0,
+		std::min(texture.contentWidth, int(width)), std::min(texture.contentHeight, int(height)), 1);
+}
+
+Presenter::~Presenter()
+{
+	if (!_thread.joinable())
+	{
+		if (_context != nullptr)
+		{
+			_platform.DestroyContext(_context);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wake.notify_one();
+	_thread.join();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include "Window.h"
+#include "GLPlatform.h"
+#include "PresentStats.h"
+#include "GpuTimer.h"
+
+class GLStateCache;
+
+// Presents a window on its own thread through a GL context shared with Unity's.
+// Frames are handed over from the render thread with a fence, so the worker never blocks Unity.
+class Presenter
+{
+public:
+	Presenter(GLPlatform& platform, PlatformDrawable drawable, unsigned int windowId, PresentStats& stats);
+	~Presenter();
+
+	// Render thread only, with Unity's context current.
+	bool Start();
+	void QueueFrame(GLStateCache& state, const WindowTexture& texture, int width, int height, UpscaleMode upscaleMode, PresentMode presentMode, bool continuous);
+
+	// Event pump thread. Only acted on in continuous mode, where the last frame is kept and can be shown again at any time.
+	void Expose(int width, int height);
+	void SetRefreshRate(int refreshRate);
+	// Main thread. A hidden window's last frame is not re-presented in continuous mode.
+	void SetVisible(bool visible);
+
+	PresentPath GetPresentPath() const;
+	PresentMode GetPresentMode() const;
+
+private:
+	// Presenter-owned copy of a frame, made on the render thread so Unity's next writes to its texture are ordered after it.
+	struct FrameCopy
+	{
+		GLuint texture;
+		GLint width;
+		GLint height;
+		GLint format;
+		// Set by the presenter when it stops reading the copy, waited on before the render thread copies into it again.
+		GLsync consumedFence;
+	};
+
+	struct Frame
+	{
+		GLsync readyFence;
+		int copy;
+		WindowTexture texture;
+		int width;
+		int height;
+		UpscaleMode upscaleMode;
+		std::chrono::steady_clock::time_point readyTime;
+	};
+
+	void Run();
+	static void CopyFrame(GLStateCache& state, const WindowTexture& texture, FrameCopy& copy);
+
+	GLPlatform& _platform;
+	const PlatformDrawable _drawable;
+	// Only used to label profiler markers.
+	const unsigned int _windowId;
+	// Owned by the window, which stops the presenter before it goes away.
+	PresentStats& _stats;
+	// Presenter thread only, its queries live on the presenter's context.
+	GpuTimer _timer;
+	PlatformContext _context;
+	std::thread _thread;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	bool _stopping;
+	bool _hasFrame;
+	Frame _frame;
+	// One copy is held by the presenter while the render thread fills the other.
+	FrameCopy _copies[2];
+	int _heldCopy;
+
+	bool _continuous;
+	PresentMode _presentMode;
+	bool _exposed;
+	bool _hidden;
+	int _width;
+	int _height;
+	UpscaleMode _upscaleMode;
+	int _refreshRate;
+	std::atomic<int> _presentPath;
+	// What the presenter's swaps were last set to, which can fall back from what the window asked for.
+	std::atomic<int> _activePresentMode;
+};
@@ -0,0 +1,150 @@
+#include "Profiler.h"
+#include "Trace.h"
+#include <atomic>
+
+IUnityProfiler* Profiler::_pProfiler = nullptr;
+IUnityProfilerCallbacks* Profiler::_pCallbacks = nullptr;
+const UnityProfilerMarkerDesc* Profiler::_markers[ProfilerMarkerCount] = {};
+
+static std::atomic<unsigned long long> _unityFrame(0);
+
+static const char* const MarkerNames[ProfilerMarkerCount] = {
+	"MultiWindow.PumpEvents",
+	"MultiWindow.CreateWindow",
+	"MultiWindow.DisposeWindow",
+	"MultiWindow.Resize",
+	"MultiWindow.Render",
+	"MultiWindow.Swap"
+};
+
+enum MarkerMetadata
+{
+	MetadataWindowId = 0,
+	MetadataWidth,
+	MetadataHeight,
+	MetadataPresentPath,
+	MetadataUnityFrame,
+	MetadataCount
+};
+
+void Profiler::Load(IUnityInterfaces* pInterfaces)
+{
+	_pCallbacks = pInterfaces->Get<IUnityProfilerCallbacks>();
+	if (_pCallbacks != nullptr)
+	{
+		_pCallbacks->RegisterFrameCallback(OnFrame, nullptr);
+	}
+
+	_pProfiler = pInterfaces->Get<IUnityProfiler>();
+	if (_pProfiler == nullptr || !_pProfiler->IsAvailable())
+	{
+		_pProfiler = nullptr;
+		return;
+	}
+
+	for (int i = 0; i < ProfilerMarkerCount; ++i)
+	{
+		const UnityProfilerCategoryId category = i == ProfilerMarkerPumpEvents ? kUnityProfilerCategoryInput : kUnityProfilerCategoryRender;
+		if (_pProfiler->CreateMarker(&_markers[i], MarkerNames[i], category, kUnityProfilerMarkerFlagDefault, MetadataCount) != 0)
+		{
+			_markers[i] = nullptr;
+			continue;
+		}
+
+		_pProfiler->SetMarkerMetadataName(_markers[i], MetadataWindowId, "Window ID", kUnityProfilerMarkerDataTypeUInt32, kUnityProfilerMarkerDataUnitUndefined);
+		_pProfiler->SetMarkerMetadataName(_markers[i], MetadataWidth, "Width", kUnityProfilerMarkerDataTypeInt32, kUnityProfilerMarkerDataUnitCount);
+		_pProfiler->SetMarkerMetadataName(_markers[i], MetadataHeight, "Height", kUnityProfilerMarkerDataTypeInt32, kUnityProfilerMarkerDataUnitCount);
+		_pProfiler->SetMarkerMetadataName(_markers[i], MetadataPresentPath, "Present path", kUnityProfilerMarkerDataTypeInt32, kUnityProfilerMarkerDataUnitUndefined);
+		_pProfiler->SetMarkerMetadataName(_markers[i], MetadataUnityFrame, "Unity frame", kUnityProfilerMarkerDataTypeUInt64, kUnityProfilerMarkerDataUnitCount);
+	}
+}
+
+void Profiler::Unload()
+{
+	if (_pCallbacks != nullptr)
+	{
+		_pCallbacks->UnregisterFrameCallback(OnFrame, nullptr);
+		_pCallbacks = nullptr;
+	}
+
+	// Marker descriptions belong to Unity and stay valid, but the interface may not outlive the plugin.
+	for (int i = 0; i < ProfilerMarkerCount; ++i)
+	{
+		_markers[i] = nullptr;
+	}
+	_pProfiler = nullptr;
+}
+
+UnityProfilerThreadId Profiler::RegisterThread(const char* name)
+{
+	UnityProfilerThreadId threadId = 0;
+	if (_pProfiler != nullptr && _pProfiler->RegisterThread(&threadId, "MultiWindow", name) != 0)
+	{
+		threadId = 0;
+	}
+
+	return threadId;
+}
+
+void Profiler::UnregisterThread(UnityProfilerThreadId threadId)
+{
+	if (_pProfiler != nullptr && threadId != 0)
+	{
+		_pProfiler->UnregisterThread(threadId);
+	}
+}
+
+unsigned long long Profiler::GetUnityFrame()
+{
+	return _unityFrame;
+}
+
+const char* Profiler::GetMarkerName(ProfilerMarker marker)
+{
+	return MarkerNames[marker];
+}
+
+void UNITY_INTERFACE_API Profiler::OnFrame(void* /*userData*/)
+{
+	++_unityFrame;
+}
+
+ProfilerScope::ProfilerScope(ProfilerMarker marker, unsigned int windowId, int width, int height, int presentPath)
+	: _pMarker(nullptr)
+	, _marker(marker)
+	, _windowId(windowId)
+	, _width(width)
+	, _height(height)
+	, _traceStart(Trace::IsRecording() ? Trace::Now() : 0)
+{
+	IUnityProfiler* pProfiler = Profiler::_pProfiler;
+	if (pProfiler == nullptr || Profiler::_markers[marker] == nullptr || !pProfiler->IsEnabled())
+	{
+		return;
+	}
+
+	const unsigned long long unityFrame = _unityFrame;
+	UnityProfilerMarkerData metadata[MetadataCount] = {};
+	metadata[MetadataWindowId] = { kUnityProfilerMarkerDataTypeUInt32, 0, 0, sizeof(windowId), &windowId };
+	metadata[MetadataWidth] = { kUnityProfilerMarkerDataTypeInt32, 0, 0, sizeof(width), &width };
+	metadata[MetadataHeight] = { kUnityProfilerMarkerDataTypeInt32, 0, 0, sizeof(height), &height };
+	metadata[MetadataPresentPath] = { kUnityProfilerMarkerDataTypeInt32, 0, 0, sizeof(presentPath), &presentPath };
+	metadata[MetadataUnityFrame] = { kUnityProfilerMarkerDataTypeUInt64, 0, 0, sizeof(unityFrame), &unityFrame };
+
+	_pMarker = Profiler::_markers[marker];
+	pProfiler->EmitEvent(_pMarker, kUnityProfilerMarkerEventTypeBegin, MetadataCount, metadata);
+}
+
+ProfilerScope::~ProfilerScope()
+{
+	if (_traceStart != 0)
+	{
+		Trace::Record(_marker, _traceStart, _windowId, _width, _height);
+	}
+
+	// The profiler can start capturing inside the scope, only end what was begun.
+	if (_pMarker != nullptr && Profiler::_pProfiler != nullptr)
+	{
+		Profiler::_pProfiler->EmitEvent(_pMarker, kUnityProfilerMarkerEventTypeEnd, 0, nullptr);
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "IUnityInterface.h"
+#include "IUnityProfiler.h"
+#include <cstdint>
+
+enum ProfilerMarker : int
+{
+	ProfilerMarkerPumpEvents = 0,
+	ProfilerMarkerCreateWindow,
+	ProfilerMarkerDisposeWindow,
+	ProfilerMarkerResize,
+	ProfilerMarkerRender,
+	ProfilerMarkerSwap,
+	ProfilerMarkerCount
+};
+
+// Emits the plugin's markers into the Unity Profiler, so UpdateWindows and the present event are broken down per window.
+// Markers are no-ops when Unity has no IUnityProfiler (before 2020.1, and in release players) or is not capturing.
+class Profiler
+{
+public:
+	// Main thread, from UnityPluginLoad and UnityPluginUnload.
+	static void Load(IUnityInterfaces* pInterfaces);
+	static void Unload();
+
+	// Presenter threads are not known to Unity, their markers are only captured once registered.
+	static UnityProfilerThreadId RegisterThread(const char* name);
+	static void UnregisterThread(UnityProfilerThreadId threadId);
+
+	// The Unity frame the profiler was last on, counted from its frame callback, so presents can be matched to frames.
+	static unsigned long long GetUnityFrame();
+	static const char* GetMarkerName(ProfilerMarker marker);
+
+private:
+	friend class ProfilerScope;
+
+	static void UNITY_INTERFACE_API OnFrame(void* userData);
+
+	static IUnityProfiler* _pProfiler;
+	static IUnityProfilerCallbacks* _pCallbacks;
+	static const UnityProfilerMarkerDesc* _markers[ProfilerMarkerCount];
+};
+
+// Begins a marker for the lifetime of the scope. Every marker carries the window ID, size, present path and Unity frame.
+// The scope is also recorded into the Trace timeline while it is recording.
+class ProfilerScope
+{
+public:
+	ProfilerScope(ProfilerMarker marker, unsigned int windowId = 0, int width = 0, int height = 0, int presentPath = 0);
+	~ProfilerScope();
+
+	ProfilerScope(const ProfilerScope&) = delete;
+	ProfilerScope& operator=(const ProfilerScope&) = delete;
+
+private:
+	const UnityProfilerMarkerDesc* _pMarker;
+	const ProfilerMarker _marker;
+	const unsigned int _windowId;
+	const int _width;
+	const int _height;
+	// Zero when the trace was not recording as the scope began.
+	uint64_t _traceStart;
+};
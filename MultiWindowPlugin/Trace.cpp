@@ -0,0 +1,246 @@
+#include "Trace.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct TraceEvent
+{
+	// Index + 1 of the event in the slot once it is complete, zero while it is being written.
+	std::atomic<uint64_t> sequence;
+	uint64_t start;
+	uint64_t duration;
+	uint32_t threadId;
+	uint32_t windowId;
+	int32_t width;
+	int32_t height;
+	int32_t marker;
+};
+
+struct TraceSample
+{
+	uint64_t start;
+	uint64_t duration;
+	uint32_t threadId;
+	uint32_t windowId;
+	int32_t width;
+	int32_t height;
+	int32_t marker;
+};
+
+std::atomic<bool> Trace::_recording(false);
+
+static const std::chrono::steady_clock::time_point _epoch = std::chrono::steady_clock::now();
+static std::unique_ptr<TraceEvent[]> _pEvents;
+static std::atomic<uint64_t> _writeIndex(0);
+static std::atomic<uint32_t> _nextThreadId(1);
+static thread_local uint32_t _threadId = 0;
+
+// Guards the snapshot, which dumps copy the ring into before writing so the file is written without racing writers.
+static std::mutex _dumpMutex;
+static std::unique_ptr<TraceSample[]> _pSnapshot;
+
+// Spike dumps. The main thread only sets a flag, the file is written on the dump thread.
+static std::thread _dumpThread;
+static std::mutex _spikeMutex;
+static std::condition_variable _spikeWake;
+static bool _spikeRequested = false;
+static bool _dumpThreadStopping = false;
+static std::string _spikeDirectory;
+static unsigned int _spikeCount = 0;
+static float _spikeThresholdMilliseconds = 0.0f;
+static std::chrono::steady_clock::time_point _lastFrame;
+
+uint64_t Trace::Now()
+{
+	return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count());
+}
+
+void Trace::Record(ProfilerMarker marker, uint64_t start, unsigned int windowId, int width, int height)
+{
+	if (_threadId == 0)
+	{
+		_threadId = _nextThreadId++;
+	}
+
+	const uint64_t end = Now();
+	const uint64_t index = _writeIndex.fetch_add(1, std::memory_order_relaxed);
+	TraceEvent& event = _pEvents[index & (Capacity - 1)];
+	event.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	event.start = start;
+	event.duration = end - start;
+	event.threadId = _threadId;
+	event.windowId = windowId;
+	event.width = width;
+	event.height = height;
+	event.marker = marker;
+	event.sequence.store(index + 1, std::memory_order_release);
+}
+
+void Trace::SetRecording(bool enabled)
+{
+	if (enabled && _pEvents == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(_dumpMutex);
+		_pEvents.reset(new TraceEvent[Capacity]());
+		_pSnapshot.reset(new TraceSample[Capacity]);
+	}
+
+	_recording = enabled && _pEvents != nullptr;
+}
+
+static bool WriteTrace(const char* path)
+{
+	std::lock_guard<std::mutex> lock(_dumpMutex);
+	if (_pEvents == nullptr)
+	{
+		return false;
+	}
+
+	const uint64_t end = _writeIndex.load(std::memory_order_acquire);
+	const uint64_t begin = end > Trace::Capacity ? end - Trace::Capacity : 0;
+	uint32_t count = 0;
+	for (uint64_t index = begin; index < end; ++index)
+	{
+		TraceEvent& event = _pEvents[index & (Trace::Capacity - 1)];
+		if (event.sequence.load(std::memory_order_acquire) != index + 1)
+		{
+			continue;
+		}
+
+		TraceSample& sample = _pSnapshot[count];
+		sample.start = event.start;
+		sample.duration = event.duration;
+		sample.threadId = event.threadId;
+		sample.windowId = event.windowId;
+		sample.width = event.width;
+		sample.height = event.height;
+		sample.marker = event.marker;
+
+		// Overwritten by a writer that wrapped around while it was copied.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (event.sequence.load(std::memory_order_relaxed) == index + 1)
+		{
+			++count;
+		}
+	}
+
+	FILE* pFile = std::fopen(path, "w");
+	if (pFile == nullptr)
+	{
+		return false;
+	}
+
+	std::fprintf(pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const TraceSample& sample = _pSnapshot[i];
+		std::fprintf(pFile, "{\"name\":\"%s\",\"cat\":\"MultiWindow\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+			"\"args\":{\"window\":%u,\"width\":%d,\"height\":%d}}%s\n",
+			Profiler::GetMarkerName(ProfilerMarker(sample.marker)), sample.threadId, sample.start / 1000.0, sample.duration / 1000.0,
+			sample.windowId, sample.width, sample.height, i + 1 < count ? "," : "");
+	}
+	std::fprintf(pFile, "]}\n");
+
+	const bool written = std::ferror(pFile) == 0;
+	std::fclose(pFile);
+	return written;
+}
+
+bool Trace::Dump(const char* path)
+{
+	return WriteTrace(path);
+}
+
+static void RunDumpThread()
+{
+	std::unique_lock<std::mutex> lock(_spikeMutex);
+	while (true)
+	{
+		_spikeWake.wait(lock, [] { return _spikeRequested || _dumpThreadStopping; });
+		if (_dumpThreadStopping)
+		{
+			return;
+		}
+
+		const std::string path = _spikeDirectory + "/multiwindow-spike-" + std::to_string(++_spikeCount) + ".json";
+		lock.unlock();
+		WriteTrace(path.c_str());
+		lock.lock();
+
+		// Spikes during the dump are part of the same hitch.
+		_spikeRequested = false;
+	}
+}
+
+static void StopDumpThread()
+{
+	if (!_dumpThread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_spikeMutex);
+		_dumpThreadStopping = true;
+	}
+	_spikeWake.notify_one();
+	_dumpThread.join();
+	_dumpThreadStopping = false;
+}
+
+void Trace::SetSpikeDump(const char* directory, float thresholdMilliseconds)
+{
+	StopDumpThread();
+
+	_spikeThresholdMilliseconds = directory != nullptr ? thresholdMilliseconds : 0.0f;
+	if (_spikeThresholdMilliseconds <= 0.0f)
+	{
+		return;
+	}
+
+	_spikeDirectory = directory;
+	_spikeRequested = false;
+	_lastFrame = std::chrono::steady_clock::time_point();
+	_dumpThread = std::thread(RunDumpThread);
+}
+
+void Trace::EndFrame()
+{
+	if (_spikeThresholdMilliseconds <= 0.0f || !IsRecording())
+	{
+		return;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	const bool spike = _lastFrame != std::chrono::steady_clock::time_point() &&
+		std::chrono::duration<float, std::milli>(now - _lastFrame).count() > _spikeThresholdMilliseconds;
+	_lastFrame = now;
+	if (!spike)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_spikeMutex);
+		_spikeRequested = true;
+	}
+	_spikeWake.notify_one();
+}
+
+void Trace::Shutdown()
+{
+	StopDumpThread();
+	_spikeThresholdMilliseconds = 0.0f;
+	_recording = false;
+
+	std::lock_guard<std::mutex> lock(_dumpMutex);
+	_pEvents.reset();
+	_pSnapshot.reset();
+	_writeIndex = 0;
+}
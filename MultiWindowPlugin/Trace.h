@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Profiler.h"
+#include <atomic>
+#include <cstdint>
+
+// Timeline of the plugin's profiler scopes, kept in a fixed ring so hitches reported from the field can be analysed
+// offline in chrome://tracing or Perfetto. Recording is lock free: writers claim a slot with one atomic increment and
+// publish it with a sequence number, readers skip slots that are being overwritten. Nothing is allocated after
+// SetRecording, spike dumps are written from their own thread.
+class Trace
+{
+public:
+	// Must be a power of two.
+	static const uint32_t Capacity = 1 << 16;
+
+	// Main thread. The ring is allocated the first time recording is enabled and kept until Shutdown.
+	static void SetRecording(bool enabled);
+	static bool IsRecording()
+	{
+		return _recording.load(std::memory_order_relaxed);
+	}
+
+	// Writes the events in the ring as Chrome trace JSON. Returns false if the file could not be written.
+	static bool Dump(const char* path);
+	// Main thread, once per Unity frame. A frame longer than the threshold makes the dump thread write the ring into
+	// directory. A threshold of zero stops spike dumps.
+	static void SetSpikeDump(const char* directory, float thresholdMilliseconds);
+	static void EndFrame();
+	static void Shutdown();
+
+	// Any thread, called when a ProfilerScope ends.
+	static uint64_t Now();
+	static void Record(ProfilerMarker marker, uint64_t start, unsigned int windowId, int width, int height);
+
+private:
+	static std::atomic<bool> _recording;
+};
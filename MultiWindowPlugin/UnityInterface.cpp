@@ -1,15 +1,71 @@
 #include "UnityInterface.h"
 #include "IUnityGraphics.h"
 #include "Window.h"
+#include "FramePacer.h"
+#include "GLStateCache.h"
+#include "GpuTimer.h"
+#include "GLDiagnostics.h"
+#include "WindowPool.h"
+#include "EventPump.h"
+#include "PresentScheduler.h"
+#include "GLPlatform.h"
+#ifdef WINDOW_PLUGIN_VULKAN
+#include "VulkanDevice.h"
+#endif
+#include "Profiler.h"
+#include "Trace.h"
 #include <vector>
 #include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <chrono>
 
 MessageFunction _messageDelegate = nullptr;
 IUnityInterfaces* _pUnityInterfaces = nullptr;
 IUnityGraphics* _pGraphicsApi = nullptr;
 UnityGfxRenderer _deviceType = kUnityGfxRendererNull;
-HGLRC _unityContext = nullptr;
-std::vector<Window*> _windows;
+GLPlatform* _pPlatform = nullptr;
+VulkanDevice* _pVulkanDevice = nullptr;
+WindowRegistry _windows;
+
+// _windows is only modified on the main thread, but the render thread iterates it while presenting.
+// Never call back into managed code while holding this lock: Unity's main thread may itself be waiting on the render thread.
+std::mutex _windowsMutex;
+
+FramePacer _framePacer;
+GLStateCache _renderThreadState(true);
+// Times draws on Unity's context, tagged with their window. Enough queries for every window to be a few frames behind.
+GpuTimer _renderThreadTimer(64);
+DiagnosticsContext _unityDiagnostics = {};
+std::atomic<bool> _threadedPresentation(false);
+std::atomic<bool> _continuousPresentation(false);
+unsigned int _resizeDebounceMilliseconds = 50;
+PresentScheduler _presentScheduler;
+WindowPool _windowPool;
+EventPump _eventPump;
+
+EventPump& GetEventPump()
+{
+	return _eventPump;
+}
+
+// Event pump thread. The window stays valid until the calling command returns, windows are only unregistered from the
+// pump on its own thread. A window already removed from the registry is not resolved anymore.
+Window* FindOnEventPump(WindowHandle windowHandle)
+{
+	Uint32 windowId;
+	{
+		std::lock_guard<std::mutex> lock(_windowsMutex);
+		const Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
+		{
+			return nullptr;
+		}
+		windowId = window->ID;
+	}
+
+	return _eventPump.Find(windowId);
+}
 
 void Log(const std::string& message)
 {
@@ -58,7 +114,12 @@ extern "C"
 			_deviceType = _pGraphicsApi->GetRenderer();
 			if (_deviceType == kUnityGfxRendererOpenGLCore)
 			{
-				_unityContext = wglGetCurrentContext();
+				delete _pPlatform;
+				_pPlatform = GLPlatform::Create();
+				if (_pPlatform == nullptr)
+				{
+					Log("No supported GL platform owns Unity's context, windows will not be presented.");
+				}
 
 				glewExperimental = GL_TRUE;
 				if (glewInit() != GLEW_OK)
@@ -68,6 +129,24 @@ extern "C"
 
 				Window::LoadResources();
 			}
+			else if (_deviceType == kUnityGfxRendererVulkan)
+			{
+#ifdef WINDOW_PLUGIN_VULKAN
+				delete _pVulkanDevice;
+				_pVulkanDevice = VulkanDevice::Create(_pUnityInterfaces->Get<IUnityGraphicsVulkan>());
+				if (_pVulkanDevice == nullptr)
+				{
+					Log("Unity's Vulkan device cannot present to other windows, windows will not be presented.");
+				}
+				else
+				{
+					_pVulkanDevice->ConfigurePresentEvent(PresentWindowsEvent);
+					_windowPool.SetGraphicsFlag(SDL_WINDOW_VULKAN);
+				}
+#else
+				Log("The plugin was built without its Vulkan backend, windows will not be presented.");
+#endif
+			}
 		}
 		
 		// Cleanup graphics API implementation upon shutdown
@@ -75,41 +154,229 @@ extern "C"
 		{
 			if (_deviceType == kUnityGfxRendererOpenGLCore)
 			{
+				std::lock_guard<std::mutex> lock(_windowsMutex);
+				for (auto it = _windows.begin(); it != _windows.end(); ++it)
+				{
+					Window* window = *it;
+					window->StopPresenter();
+				}
+
+				_framePacer.Reset();
+				_renderThreadTimer.Release();
+				GLDiagnostics::ReleaseContext(_unityDiagnostics);
 				Window::UnloadResources();
 			}
+#ifdef WINDOW_PLUGIN_VULKAN
+			else if (_deviceType == kUnityGfxRendererVulkan)
+			{
+				std::lock_guard<std::mutex> lock(_windowsMutex);
+				for (auto it = _windows.begin(); it != _windows.end(); ++it)
+				{
+					Window* window = *it;
+					window->ReleaseVulkan();
+				}
+
+				delete _pVulkanDevice;
+				_pVulkanDevice = nullptr;
+			}
+#endif
 			
 			_deviceType = kUnityGfxRendererNull;
 		}
 	}
 	
-	void UnityPluginLoad(IUnityInterfaces* unityInterfaces) 
+#ifdef WINDOW_PLUGIN_VULKAN
+	struct VulkanPresent
+	{
+		WindowHandle window;
+		UnityVulkanImage image;
+	};
+
+	struct VulkanPresentBatch
+	{
+		std::vector<VulkanPresent> presents;
+		// Set until Unity has run the queue access callback for the batch.
+		std::atomic<bool> pending;
+	};
+
+	// Unity may run the queue access callback late, so a batch is only refilled once its callback has run. The vectors
+	// keep their capacity, presenting allocates nothing per frame.
+	static VulkanPresentBatch _vulkanPresents[2];
+	static unsigned int _nextVulkanPresents = 0;
+
+	static void UNITY_INTERFACE_API OnVulkanQueueAccess(int /*eventId*/, void* data)
+	{
+		VulkanPresentBatch* pBatch = static_cast<VulkanPresentBatch*>(data);
+		_pVulkanDevice->DestroyRetired();
+
+		// Windows may have been disposed if Unity deferred the callback.
+		{
+			std::lock_guard<std::mutex> lock(_windowsMutex);
+			for (auto it = pBatch->presents.begin(); it != pBatch->presents.end(); ++it)
+			{
+				Window* window = _windows.Get(it->window);
+				if (window != nullptr)
+				{
+					window->PresentVulkan(it->image);
+				}
+			}
+		}
+
+		pBatch->pending.store(false, std::memory_order_release);
+	}
+
+	// Unity only allows resource access outside of its queue access and submission inside it, so the textures are
+	// transitioned first and the windows presented once Unity has submitted those transitions.
+	static void PresentVulkanWindows()
+	{
+		if (_pVulkanDevice == nullptr)
+		{
+			return;
+		}
+
+		// Unity has not caught up with the batch from two frames ago, the windows keep their tickets for the next frame.
+		VulkanPresentBatch& batch = _vulkanPresents[_nextVulkanPresents];
+		if (batch.pending.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		batch.presents.clear();
+		{
+			std::lock_guard<std::mutex> lock(_windowsMutex);
+			for (auto it = _windows.begin(); it != _windows.end(); ++it)
+			{
+				Window* window = *it;
+				VulkanPresent present;
+				present.window = window->Handle;
+				if (window->ShouldPresent() && window->AccessVulkanTexture(present.image))
+				{
+					batch.presents.push_back(present);
+				}
+			}
+		}
+
+		if (batch.presents.empty() && !_pVulkanDevice->HasRetired())
+		{
+			return;
+		}
+
+		batch.pending.store(true, std::memory_order_relaxed);
+		_nextVulkanPresents = (_nextVulkanPresents + 1) % 2;
+
+		// The callback may run synchronously, so the windows lock must not be held here.
+		_pVulkanDevice->AccessQueue(OnVulkanQueueAccess, PresentWindowsEvent, &batch);
+	}
+#endif
+
+	static void UNITY_INTERFACE_API OnRenderEvent(int eventId)
+	{
+		if (eventId != PresentWindowsEvent)
+		{
+			return;
+		}
+
+#ifdef WINDOW_PLUGIN_VULKAN
+		if (_deviceType == kUnityGfxRendererVulkan)
+		{
+			PresentVulkanWindows();
+			return;
+		}
+#endif
+
+		if (_deviceType != kUnityGfxRendererOpenGLCore || _pPlatform == nullptr)
+		{
+			return;
+		}
+
+		GLDiagnostics::UpdateContext(_unityDiagnostics);
+
+		if (!_framePacer.BeginFrame())
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(_windowsMutex);
+
+		// Unity's context is current on the render thread, rebind it to its own drawable once all windows are presented.
+		_pPlatform->BeginPresent();
+		_renderThreadState.BeginPass();
+
+		// The handles of windows disposed since their draw was timed no longer resolve.
+		unsigned long long tag;
+		float gpuMilliseconds;
+		while (_renderThreadTimer.Collect(tag, gpuMilliseconds))
+		{
+			Window* window = _windows.Get(tag);
+			if (window != nullptr)
+			{
+				window->RecordGpuTime(gpuMilliseconds);
+			}
+		}
+
+		const bool threaded = _threadedPresentation;
+		const bool continuous = _continuousPresentation;
+		for (auto it = _windows.begin(); it != _windows.end(); ++it)
+		{
+			Window* window = *it;
+			if (!window->ShouldPresent())
+			{
+				continue;
+			}
+
+			// Mailbox is emulated with a presenter swapping on vblank, whether or not presentation is threaded.
+			if (threaded || window->GetRequestedPresentMode() == PresentModeMailbox)
+			{
+				window->QueuePresent(_renderThreadState, _renderThreadTimer, threaded && continuous);
+			}
+			else
+			{
+				window->StopPresenter();
+				window->Render(_renderThreadState, _renderThreadTimer);
+			}
+		}
+
+		_renderThreadState.EndPass();
+		_pPlatform->EndPresent();
+		_framePacer.EndFrame();
+	}
+
+	static void UNITY_INTERFACE_API OnRenderEventAndData(int eventId, void* data)
+	{
+		if (eventId != MarkWindowDirtyEvent)
+		{
+			return;
+		}
+
+		// The window may have been disposed between the event being recorded and it being executed.
+		std::lock_guard<std::mutex> lock(_windowsMutex);
+		Window* window = _windows.Get(WindowHandle(reinterpret_cast<uintptr_t>(data)));
+		if (window != nullptr)
+		{
+			window->MarkDirty();
+		}
+	}
+
+	UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UnityPluginLoad(IUnityInterfaces* unityInterfaces)
 	{
 		_pUnityInterfaces = unityInterfaces;
 		_pGraphicsApi = unityInterfaces->Get<IUnityGraphics>();
 		_pGraphicsApi->RegisterDeviceEventCallback(OnGraphicsDeviceEvent);
+		Profiler::Load(unityInterfaces);
 	}
 
-	void UnityPluginUnload()
+	UNITY_INTERFACE_EXPORT void UNITY_INTERFACE_API UnityPluginUnload()
 	{
 		_pGraphicsApi->UnregisterDeviceEventCallback(OnGraphicsDeviceEvent);
 		_pGraphicsApi = nullptr;
+		Profiler::Unload();
 	}
 
-	void InitPlugin(
-		MessageFunction messageDelegate, 
-		CloseFunction closeDelegate, 
-		ResizeFunction resizeDelegate, 
-		MouseUpdateFuncton mouseDelegate,
-		MoveFunction moveDelegate
-	)
+	void InitPlugin(MessageFunction messageDelegate)
 	{
 		_messageDelegate = messageDelegate;
-		Window::CloseDelegate = closeDelegate;
-		Window::ResizeDelegate = resizeDelegate;
-		Window::MouseDelegate = mouseDelegate;
-		Window::MoveDelegate = moveDelegate;
 
-		if (SDL_Init(SDL_INIT_VIDEO) < 0)
+		if (!_eventPump.Start())
 		{
 			Log("SDL could not initialise!");
 			return;
@@ -123,103 +390,372 @@ extern "C"
 		SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
 		SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
 		SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 0);
-		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 0);
+		// Unity's context is made current on the windows, they need its double-buffered format for swaps to mean anything.
+		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 	}
 
-	void ForwardWindowEvent(const SDL_Event& event)
+	int UpdateWindows(WindowEvent* events, int capacity)
 	{
-		Window* targetWindow = nullptr;
-		for (auto it = _windows.begin(); it != _windows.end(); ++it)
 		{
-			Window* window = *it;
-			if (window->ID == event.window.windowID)
+			ProfilerScope scope(ProfilerMarkerPumpEvents);
+			Window::Inputs.BeginFrame();
+			for (auto it = _windows.begin(); it != _windows.end(); ++it)
 			{
-				targetWindow = window;
-				break;
+				(*it)->ProcessEvents();
 			}
 		}
 
-		if (targetWindow != nullptr)
+		for (auto it = _windows.begin(); it != _windows.end(); ++it)
+		{
+			Window* window = *it;
+			window->UpdateResize(_resizeDebounceMilliseconds);
+			window->UpdateVisibility();
+		}
+		_presentScheduler.Schedule(_windows);
+
+		_eventPump.Post([] { _windowPool.Refill(); });
+		Trace::EndFrame();
+		return Window::Events.Drain(events, capacity);
+	}
+
+	UnityRenderingEvent GetRenderEventFunc()
+	{
+		return OnRenderEvent;
+	}
+
+	UnityRenderingEventAndData GetRenderEventAndDataFunc()
+	{
+		return OnRenderEventAndData;
+	}
+
+	void SetFramePacing(int mode, int framesInFlight)
+	{
+		_framePacer.Configure(FramePacingMode(mode), framesInFlight);
+	}
+
+	void SetThreadedPresentation(bool enabled)
+	{
+		_threadedPresentation = enabled;
+	}
+
+	void SetContinuousPresentation(bool enabled)
+	{
+		_continuousPresentation = enabled;
+	}
+
+	void SetResizeDebounce(int milliseconds)
+	{
+		_resizeDebounceMilliseconds = unsigned(std::max(milliseconds, 0));
+	}
+
+	void SetPresentBudget(int microseconds)
+	{
+		_presentScheduler.SetBudget(unsigned(std::max(microseconds, 0)));
+	}
+
+	void SetGpuTiming(bool enabled)
+	{
+		GpuTimer::SetEnabled(enabled);
+	}
+
+	void SetTraceRecording(bool enabled)
+	{
+		Trace::SetRecording(enabled);
+	}
+
+	bool DumpTrace(const char* path)
+	{
+		return Trace::Dump(path);
+	}
+
+	void SetTraceSpikeDump(const char* directory, float thresholdMilliseconds)
+	{
+		Trace::SetSpikeDump(directory, thresholdMilliseconds);
+	}
+
+	void SetDiagnosticsLevel(int level)
+	{
+		GLDiagnostics::SetLevel(DiagnosticsLevel(std::min(std::max(level, int(DiagnosticsOff)), int(DiagnosticsAll))));
+	}
+
+	int PollDiagnostics(DiagnosticMessage* messages, int capacity, unsigned int* dropped)
+	{
+		return GLDiagnostics::Poll(messages, capacity, dropped);
+	}
+
+	void GetGLStateCounters(GLStateCounters* counters)
+	{
+		GLStateCache::GetCounters(*counters);
+	}
+		
+	WindowHandle CreateNewWindow(const char* title, int width, int height, float renderScale, bool resizable, void* nativeTexture)
+	{
+		// The window has no ID until its SDL window exists, the marker only carries the requested size.
+		ProfilerScope scope(ProfilerMarkerCreateWindow, 0, width, height);
+		const auto start = std::chrono::steady_clock::now();
+		Window* window = new Window(std::string(title), _pPlatform, _pVulkanDevice, width, height, renderScale, resizable, nativeTexture);
+		SDL_Window* pPooledWindow = nullptr;
+		bool created = false;
+		_eventPump.Invoke([window, &pPooledWindow, &created]
+		{
+			pPooledWindow = _windowPool.Take();
+			created = window->CreateContext(pPooledWindow);
+		});
+
+		if (!created)
+		{
+			delete window;
+			return 0;
+		}
+
 		{
-			targetWindow->HandleEvent(event);
+			std::lock_guard<std::mutex> lock(_windowsMutex);
+			window->Handle = _windows.Add(window);
 		}
+
+		_windowPool.RecordCreation(pPooledWindow != nullptr, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+		return window->Handle;
 	}
 
-	void UpdateWindows()
+	void SetWindowPoolSize(int size)
 	{
-		SDL_Event event;
-		while (SDL_PollEvent(&event) != 0)
+		_eventPump.Post([size] { _windowPool.SetCapacity(size); });
+	}
+
+	void GetWindowCreationStats(WindowCreationStats* stats)
+	{
+		_windowPool.GetStats(*stats);
+	}
+
+	void DisposeWindow(WindowHandle windowHandle)
+	{
+		Window* window;
+		{
+			std::lock_guard<std::mutex> lock(_windowsMutex);
+			window = _windows.Remove(windowHandle);
+		}
+
+		if (window == nullptr)
+		{
+			return;
+		}
+
+		// Outside the lock: the destructor waits for the event pump, which a modal move or size loop can hold for
+		// as long as the user keeps the mouse down, and the render thread must not wait with it.
+		ProfilerScope scope(ProfilerMarkerDisposeWindow, window->ID);
+		Window::Events.Remove(windowHandle);
+		delete window;
+	}
+
+	void SetWindowPosition(WindowHandle windowHandle, int x, int y)
+	{
+		_eventPump.Post([windowHandle, x, y]
 		{
-			if (event.type == SDL_WINDOWEVENT)
+			Window* window = FindOnEventPump(windowHandle);
+			if (window != nullptr)
 			{
-				ForwardWindowEvent(event);
+				window->SetPosition(x, y);
 			}
+		});
+	}
+
+	void SetWindowDirtyTracking(WindowHandle windowHandle, bool enabled)
+	{
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
+		{
+			return;
 		}
 
-		for (auto it = _windows.begin(); it != _windows.end(); ++it)
+		window->SetDirtyTracking(enabled);
+	}
+
+	void MarkWindowDirty(WindowHandle windowHandle)
+	{
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
 		{
-			Window* window = *it;
-			window->Render();
+			return;
 		}
+
+		window->MarkDirty();
 	}
-		
-	Window* CreateNewWindow(const char* title, int width, int height, bool resizable, unsigned int textureHandle)
+
+	void GetWindowPresentCounters(WindowHandle windowHandle, unsigned int* presented, unsigned int* skipped)
 	{
-		Window* window = new Window(std::string(title), _unityContext, width, height, resizable, textureHandle);
-		if (!window->CreateContext())
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
 		{
-			delete window;
-			return nullptr;
+			return;
 		}
 
-		_windows.push_back(window);
-		return window;
+		window->GetPresentCounters(*presented, *skipped);
 	}
 
-	void DisposeWindow(Window* window)
+	void SetWindowPresentMode(WindowHandle windowHandle, int mode, int bufferCount)
 	{
+		Window* window = _windows.Get(windowHandle);
 		if (window == nullptr)
 		{
 			return;
 		}
 
-		const auto windowIndex = std::find(_windows.begin(), _windows.end(), window);
-		if (windowIndex != _windows.end())
+		window->SetPresentMode(PresentMode(mode), bufferCount);
+	}
+
+	void GetWindowPresentMode(WindowHandle windowHandle, int* mode, int* bufferCount)
+	{
+		PresentMode presentMode = PresentModeVsync;
+		*bufferCount = 0;
+
+		Window* window = _windows.Get(windowHandle);
+		if (window != nullptr)
 		{
-			_windows.erase(windowIndex);
+			window->GetPresentMode(presentMode, *bufferCount);
 		}
+		*mode = presentMode;
+	}
 
-		delete window;
+	int GetWindowPresentPath(WindowHandle windowHandle)
+	{
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
+		{
+			return PresentPathNone;
+		}
+
+		return window->GetPresentPath();
+	}
+
+	float GetWindowFirstPresentLatency(WindowHandle windowHandle)
+	{
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
+		{
+			return -1.0f;
+		}
+
+		return window->GetFirstPresentLatency();
+	}
+
+	int GetWindowStats(WindowStats* stats, int capacity)
+	{
+		std::lock_guard<std::mutex> lock(_windowsMutex);
+		const int count = _windows.Count();
+		for (int i = 0; i < std::min(count, capacity); ++i)
+		{
+			stats[i].window = _windows[i]->Handle;
+			_windows[i]->GetStats(stats[i]);
+		}
+
+		return count;
+	}
+
+	void SetWindowRenderScale(WindowHandle windowHandle, float renderScale)
+	{
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
+		{
+			return;
+		}
+
+		window->SetRenderScale(renderScale);
+	}
+
+	void SetWindowTexture(WindowHandle windowHandle, void* nativeTexture, int contentWidth, int contentHeight)
+	{
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
+		{
+			return;
+		}
+
+		window->SetTexture(nativeTexture, std::max(contentWidth, 1), std::max(contentHeight, 1));
 	}
 
-	void SetWindowPosition(Window* windowHandle, int x, int y)
+	void SetWindowUpscaleMode(WindowHandle windowHandle, int mode)
 	{
-		if (windowHandle == nullptr)
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
 		{
 			return;
 		}
 
-		windowHandle->SetPosition(x, y);
+		window->SetUpscaleMode(UpscaleMode(mode));
 	}
 
-	void DragWindow(Window* windowHandle)
+	void SetWindowTargetRate(WindowHandle windowHandle, float rate)
 	{
-		if (windowHandle == nullptr)
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
 		{
 			return;
 		}
 
-		windowHandle->Drag();
+		window->SetTargetRate(rate);
+	}
+
+	int GetWindowPresentSchedule(WindowHandle windowHandle)
+	{
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
+		{
+			return PresentNotDue;
+		}
+
+		return window->GetSchedule();
+	}
+
+	WindowInputState* GetWindowInputStates(int* capacity)
+	{
+		*capacity = WindowInputTable::Capacity;
+		return Window::Inputs.Data();
+	}
+
+	int GetWindowInputSlot(WindowHandle windowHandle)
+	{
+		Window* window = _windows.Get(windowHandle);
+		if (window == nullptr)
+		{
+			return -1;
+		}
+
+		return window->GetInputSlot();
+	}
+
+	void DragWindow(WindowHandle windowHandle)
+	{
+		_eventPump.Post([windowHandle]
+		{
+			Window* window = FindOnEventPump(windowHandle);
+			if (window != nullptr)
+			{
+				window->Drag();
+			}
+		});
 	}
 
 	void ShutdownPlugin()
 	{
-		for (auto it = _windows.begin(); it != _windows.end(); ++it)
+		std::vector<Window*> windows;
+		{
+			std::lock_guard<std::mutex> lock(_windowsMutex);
+			windows.assign(_windows.begin(), _windows.end());
+			_windows.Clear();
+		}
+
+		// Same as DisposeWindow, each destructor waits for the event pump.
+		for (auto it = windows.begin(); it != windows.end(); ++it)
 		{
 			delete *it;
 		}
-		_windows.clear();
+		_eventPump.Invoke([] { _windowPool.Clear(); });
+		Window::Events.Clear();
+
+		delete _pPlatform;
+		_pPlatform = nullptr;
 
-		SDL_Quit();
+		_eventPump.Stop();
+		Trace::Shutdown();
 	}
 }
\ No newline at end of file
@@ -1,30 +1,91 @@
 #pragma once
 
 #include <string>
+#include "IUnityGraphics.h"
+#include "WindowRegistry.h"
 
-#define DllExport __declspec(dllexport)
+#define DllExport UNITY_INTERFACE_EXPORT
 
-class Window;
+struct GLStateCounters;
+struct WindowCreationStats;
+struct WindowStats;
+struct DiagnosticMessage;
+struct WindowEvent;
+struct WindowInputState;
 
-typedef void (__stdcall *MessageFunction)(const char* message);
-typedef void (__stdcall *CloseFunction)(Window* window);
-typedef unsigned int (__stdcall *ResizeFunction)(Window* window, int width, int height);
-typedef void(__stdcall *MouseUpdateFuncton)(Window* window, int mouseX, int mouseY, unsigned int buttonMask);
-typedef void(__stdcall* MoveFunction)(Window* window, int mouseX, int mouseY, bool insideUnityWindow);
+typedef void (UNITY_INTERFACE_API *MessageFunction)(const char* message);
+
+// Event IDs understood by the functions returned from GetRenderEventFunc and GetRenderEventAndDataFunc.
+enum RenderEvent
+{
+	PresentWindowsEvent = 1,
+	// Data is the WindowHandle to mark as changed, which only fits on 64-bit players.
+	MarkWindowDirtyEvent = 2
+};
 
 extern "C"
 {
-	DllExport void InitPlugin(MessageFunction messageDelegate, CloseFunction closeDelegate, ResizeFunction resizeDelegate, MouseUpdateFuncton mouseDelegate, MoveFunction moveDelegate);
+	DllExport void InitPlugin(MessageFunction messageDelegate);
 	DllExport void ShutdownPlugin();
 
-	DllExport Window* CreateNewWindow(const char* title, int width, int height, bool resizeable, unsigned int textureHandle);
-	DllExport void UpdateWindows();
-	DllExport void DisposeWindow(Window* windowHandle);
-	DllExport void SetWindowPosition(Window* windowHandle, int x, int y);
-	DllExport void DragWindow(Window* windowHandle);
+	DllExport WindowHandle CreateNewWindow(const char* title, int width, int height, float renderScale, bool resizeable, void* nativeTexture);
+	DllExport void SetWindowPoolSize(int size);
+	DllExport void GetWindowCreationStats(WindowCreationStats* stats);
+	// Applies the window messages received since the last call and moves up to capacity of the frame's events into the
+	// array, returning how many.
+	DllExport int UpdateWindows(WindowEvent* events, int capacity);
+	DllExport UnityRenderingEvent GetRenderEventFunc();
+	DllExport UnityRenderingEventAndData GetRenderEventAndDataFunc();
+	DllExport void SetFramePacing(int mode, int framesInFlight);
+	DllExport void SetThreadedPresentation(bool enabled);
+	DllExport void SetContinuousPresentation(bool enabled);
+	DllExport void SetResizeDebounce(int milliseconds);
+	// Caps the estimated cost of the windows presented in one frame, zero presents every due window.
+	DllExport void SetPresentBudget(int microseconds);
+	DllExport void SetGpuTiming(bool enabled);
+	DllExport void SetTraceRecording(bool enabled);
+	// Writes the recorded timeline to path as Chrome trace JSON.
+	DllExport bool DumpTrace(const char* path);
+	// Dumps the timeline into directory whenever a frame takes longer than the threshold. Zero disables it.
+	DllExport void SetTraceSpikeDump(const char* directory, float thresholdMilliseconds);
+	// Reports GL messages at or above a DiagnosticsLevel through KHR_debug, off by default.
+	DllExport void SetDiagnosticsLevel(int level);
+	// Moves pending messages into the array and returns how many, dropped receives the number filtered out since the last poll.
+	DllExport int PollDiagnostics(DiagnosticMessage* messages, int capacity, unsigned int* dropped);
+	DllExport void GetGLStateCounters(GLStateCounters* counters);
+	DllExport void DisposeWindow(WindowHandle windowHandle);
+	DllExport void SetWindowPosition(WindowHandle windowHandle, int x, int y);
+	DllExport void DragWindow(WindowHandle windowHandle);
+	DllExport void SetWindowDirtyTracking(WindowHandle windowHandle, bool enabled);
+	DllExport void MarkWindowDirty(WindowHandle windowHandle);
+	DllExport void GetWindowPresentCounters(WindowHandle windowHandle, unsigned int* presented, unsigned int* skipped);
+	DllExport int GetWindowPresentPath(WindowHandle windowHandle);
+	// Asks for a PresentMode and a number of swapchain images, zero leaves the count to the driver. OpenGL windows are
+	// always double-buffered.
+	DllExport void SetWindowPresentMode(WindowHandle windowHandle, int mode, int bufferCount);
+	// The mode and image count the window actually presents with, which fall back where the driver lacks support.
+	DllExport void GetWindowPresentMode(WindowHandle windowHandle, int* mode, int* bufferCount);
+	DllExport float GetWindowFirstPresentLatency(WindowHandle windowHandle);
+	// Fills up to capacity entries and returns the number of windows, which may be larger.
+	DllExport int GetWindowStats(WindowStats* stats, int capacity);
+	DllExport void SetWindowRenderScale(WindowHandle windowHandle, float renderScale);
+	// Answers a WindowEventResize with the new texture's Texture.GetNativeTexturePtr and the size its content is rendered at.
+	DllExport void SetWindowTexture(WindowHandle windowHandle, void* nativeTexture, int contentWidth, int contentHeight);
+	DllExport void SetWindowUpscaleMode(WindowHandle windowHandle, int mode);
+	// Presents the window at most rate times a second, zero or less at Unity's frame rate.
+	DllExport void SetWindowTargetRate(WindowHandle windowHandle, float rate);
+	// The PresentSchedule decided for the window by the last UpdateWindows.
+	DllExport int GetWindowPresentSchedule(WindowHandle windowHandle);
+	// The input state of every window in one array that stays at the same address while the plugin is loaded.
+	DllExport WindowInputState* GetWindowInputStates(int* capacity);
+	// The window's index into that array, -1 if there were more windows than slots.
+	DllExport int GetWindowInputSlot(WindowHandle windowHandle);
 }
 
 void Log(const std::string& message);
+// Owns SDL, its windows must be created and destroyed through it.
+class EventPump;
+EventPump& GetEventPump();
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
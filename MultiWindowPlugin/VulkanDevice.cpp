@@ -0,0 +1,172 @@
+#ifdef WINDOW_PLUGIN_VULKAN
+#include "VulkanDevice.h"
+#include "VulkanSwapchain.h"
+#include "UnityInterface.h"
+#include "SDL_vulkan.h"
+
+VulkanDevice::VulkanDevice(IUnityGraphicsVulkan* pUnityVulkan)
+	: _pUnityVulkan(pUnityVulkan)
+	, _instance(pUnityVulkan->Instance())
+	, _commandPool(VK_NULL_HANDLE)
+{
+#define VULKAN_RESET_FUNCTION(name) name = nullptr;
+	VULKAN_INSTANCE_FUNCTIONS(VULKAN_RESET_FUNCTION)
+	VULKAN_DEVICE_FUNCTIONS(VULKAN_RESET_FUNCTION)
+#undef VULKAN_RESET_FUNCTION
+}
+
+VulkanDevice* VulkanDevice::Create(IUnityGraphicsVulkan* pUnityVulkan)
+{
+	if (pUnityVulkan == nullptr)
+	{
+		return nullptr;
+	}
+
+	VulkanDevice* pDevice = new VulkanDevice(pUnityVulkan);
+	if (!pDevice->LoadFunctions())
+	{
+		delete pDevice;
+		return nullptr;
+	}
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = pDevice->_instance.queueFamilyIndex;
+	if (pDevice->vkCreateCommandPool(pDevice->_instance.device, &poolInfo, nullptr, &pDevice->_commandPool) != VK_SUCCESS)
+	{
+		delete pDevice;
+		return nullptr;
+	}
+
+	return pDevice;
+}
+
+bool VulkanDevice::LoadFunctions()
+{
+	const VkInstance instance = _instance.instance;
+	const PFN_vkGetInstanceProcAddr getInstanceProcAddr = _instance.getInstanceProcAddr;
+
+#define VULKAN_LOAD_INSTANCE_FUNCTION(name) name = reinterpret_cast<PFN_##name>(getInstanceProcAddr(instance, #name));
+	VULKAN_INSTANCE_FUNCTIONS(VULKAN_LOAD_INSTANCE_FUNCTION)
+#undef VULKAN_LOAD_INSTANCE_FUNCTION
+
+	if (vkGetDeviceProcAddr == nullptr)
+	{
+		return false;
+	}
+
+	const VkDevice device = _instance.device;
+#define VULKAN_LOAD_DEVICE_FUNCTION(name) name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #name));
+	VULKAN_DEVICE_FUNCTIONS(VULKAN_LOAD_DEVICE_FUNCTION)
+#undef VULKAN_LOAD_DEVICE_FUNCTION
+
+	// The surface and swapchain functions are only there if Unity enabled their extensions, which it does for its own window.
+	bool loaded = true;
+#define VULKAN_CHECK_FUNCTION(name) \
+	if (name == nullptr) \
+	{ \
+		Log("Unity's Vulkan device does not provide " #name "."); \
+		loaded = false; \
+	}
+	VULKAN_INSTANCE_FUNCTIONS(VULKAN_CHECK_FUNCTION)
+	VULKAN_DEVICE_FUNCTIONS(VULKAN_CHECK_FUNCTION)
+#undef VULKAN_CHECK_FUNCTION
+
+	return loaded;
+}
+
+void VulkanDevice::ConfigurePresentEvent(int eventId)
+{
+	UnityVulkanPluginEventConfig config;
+	config.renderPassPrecondition = kUnityVulkanRenderPass_EnsureOutside;
+	config.graphicsQueueAccess = kUnityVulkanGraphicsQueueAccess_DontCare;
+	config.flags = kUnityVulkanEventConfigFlag_EnsurePreviousFrameSubmission;
+	_pUnityVulkan->ConfigureEvent(eventId, &config);
+}
+
+bool VulkanDevice::AccessTexture(void* nativeTexture, UnityVulkanImage& image)
+{
+	if (nativeTexture == nullptr)
+	{
+		return false;
+	}
+
+	return _pUnityVulkan->AccessTexture(nativeTexture, UnityVulkanWholeImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, kUnityVulkanResourceAccess_PipelineBarrier, &image);
+}
+
+void VulkanDevice::AccessQueue(UnityRenderingEventAndData callback, int eventId, void* userData)
+{
+	_pUnityVulkan->AccessQueue(callback, eventId, userData, true);
+}
+
+VkSurfaceKHR VulkanDevice::CreateSurface(SDL_Window* pWindow)
+{
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
+	if (!SDL_Vulkan_CreateSurface(pWindow, _instance.instance, &surface))
+	{
+		Log(std::string("Could not create a Vulkan surface: ") + SDL_GetError());
+		return VK_NULL_HANDLE;
+	}
+
+	return surface;
+}
+
+void VulkanDevice::Retire(VulkanSwapchain* pSwapchain)
+{
+	std::lock_guard<std::mutex> lock(_retiredMutex);
+	_retired.push_back(pSwapchain);
+}
+
+bool VulkanDevice::HasRetired()
+{
+	std::lock_guard<std::mutex> lock(_retiredMutex);
+	return !_retired.empty();
+}
+
+void VulkanDevice::DestroyRetired()
+{
+	std::vector<VulkanSwapchain*> retired;
+	{
+		std::lock_guard<std::mutex> lock(_retiredMutex);
+		retired.swap(_retired);
+	}
+
+	if (retired.empty())
+	{
+		return;
+	}
+
+	// Same as when a swapchain is recreated, rare enough to wait for the whole queue.
+	vkQueueWaitIdle(_instance.graphicsQueue);
+	for (auto it = retired.begin(); it != retired.end(); ++it)
+	{
+		delete *it;
+	}
+}
+
+const UnityVulkanInstance& VulkanDevice::GetInstance() const
+{
+	return _instance;
+}
+
+VkCommandPool VulkanDevice::GetCommandPool() const
+{
+	return _commandPool;
+}
+
+// Unity is done with its queue by the time its device shuts down.
+VulkanDevice::~VulkanDevice()
+{
+	for (auto it = _retired.begin(); it != _retired.end(); ++it)
+	{
+		delete *it;
+	}
+
+	if (_commandPool != VK_NULL_HANDLE)
+	{
+		vkDestroyCommandPool(_instance.device, _commandPool, nullptr);
+	}
+}
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+// Every Vulkan function is loaded through Unity's getInstanceProcAddr, so the plugin never links against the loader.
+#define VK_NO_PROTOTYPES
+#include "IUnityGraphics.h"
+#include "IUnityGraphicsVulkan.h"
+#include <SDL.h>
+#include <mutex>
+#include <vector>
+
+class VulkanSwapchain;
+
+#define VULKAN_INSTANCE_FUNCTIONS(X) \
+	X(vkGetDeviceProcAddr) \
+	X(vkDestroySurfaceKHR) \
+	X(vkGetPhysicalDeviceSurfaceSupportKHR) \
+	X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+	X(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+	X(vkGetPhysicalDeviceSurfacePresentModesKHR)
+
+#define VULKAN_DEVICE_FUNCTIONS(X) \
+	X(vkCreateSwapchainKHR) \
+	X(vkDestroySwapchainKHR) \
+	X(vkGetSwapchainImagesKHR) \
+	X(vkAcquireNextImageKHR) \
+	X(vkQueuePresentKHR) \
+	X(vkCreateCommandPool) \
+	X(vkDestroyCommandPool) \
+	X(vkAllocateCommandBuffers) \
+	X(vkFreeCommandBuffers) \
+	X(vkResetCommandBuffer) \
+	X(vkBeginCommandBuffer) \
+	X(vkEndCommandBuffer) \
+	X(vkCmdPipelineBarrier) \
+	X(vkCmdBlitImage) \
+	X(vkQueueSubmit) \
+	X(vkQueueWaitIdle) \
+	X(vkCreateSemaphore) \
+	X(vkDestroySemaphore) \
+	X(vkCreateFence) \
+	X(vkDestroyFence) \
+	X(vkWaitForFences) \
+	X(vkResetFences)
+
+// Unity's Vulkan device as seen by the plugin. Windows are presented on Unity's graphics queue, which the plugin may only
+// submit to from inside an AccessQueue callback, so everything recorded here is recorded from that callback too.
+class VulkanDevice
+{
+public:
+	// Returns nullptr if Unity's device cannot present, e.g. because VK_KHR_swapchain is not enabled.
+	static VulkanDevice* Create(IUnityGraphicsVulkan* pUnityVulkan);
+	~VulkanDevice();
+
+	// Windows are presented outside of any render pass, without touching the state of Unity's command buffer.
+	void ConfigurePresentEvent(int eventId);
+	// Render thread only, outside queue access. Unity records the transition to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL.
+	bool AccessTexture(void* nativeTexture, UnityVulkanImage& image);
+	// Calls back with access to the graphics queue once Unity has submitted its command buffers for this frame.
+	// Unity may run the callback later, on its submission thread.
+	void AccessQueue(UnityRenderingEventAndData callback, int eventId, void* userData);
+
+	// Event pump thread only. The window must have been created with SDL_WINDOW_VULKAN.
+	VkSurfaceKHR CreateSurface(SDL_Window* pWindow);
+
+	// Any thread. Queued presents may still wait on the swapchain's semaphores, so it is only destroyed from the next
+	// queue access callback, once the queue is idle. Swapchains still retired when the device shuts down go with it.
+	void Retire(VulkanSwapchain* pSwapchain);
+	// Render thread. Whether a queue access callback is needed even though no window presents.
+	bool HasRetired();
+	// Queue access callback only.
+	void DestroyRetired();
+
+	const UnityVulkanInstance& GetInstance() const;
+	// Only used from the queue access callback, so it needs no locking.
+	VkCommandPool GetCommandPool() const;
+
+#define VULKAN_DECLARE_FUNCTION(name) PFN_##name name;
+	VULKAN_INSTANCE_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+	VULKAN_DEVICE_FUNCTIONS(VULKAN_DECLARE_FUNCTION)
+#undef VULKAN_DECLARE_FUNCTION
+
+private:
+	explicit VulkanDevice(IUnityGraphicsVulkan* pUnityVulkan);
+	bool LoadFunctions();
+
+	IUnityGraphicsVulkan* _pUnityVulkan;
+	UnityVulkanInstance _instance;
+	VkCommandPool _commandPool;
+	std::mutex _retiredMutex;
+	std::vector<VulkanSwapchain*> _retired;
+};
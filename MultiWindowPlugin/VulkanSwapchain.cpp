@@ -0,0 +1,457 @@
+#ifdef WINDOW_PLUGIN_VULKAN
+#include "VulkanSwapchain.h"
+#include "UnityInterface.h"
+#include "Window.h"
+#include <algorithm>
+#include <cstdint>
+
+VulkanSwapchain::VulkanSwapchain(VulkanDevice& device, VkSurfaceKHR surface)
+	: _device(device)
+	, _surface(surface)
+	, _swapchain(VK_NULL_HANDLE)
+	, _extent()
+	, _width(0)
+	, _height(0)
+	, _requestedPresentMode(PresentModeVsync)
+	, _requestedImageCount(0)
+	, _presentMode(PresentModeVsync)
+	, _outOfDate(false)
+	, _failed(false)
+	, _frames()
+	, _frameIndex(0)
+{
+}
+
+VulkanSwapchain* VulkanSwapchain::Create(VulkanDevice& device, SDL_Window* pWindow)
+{
+	const VkSurfaceKHR surface = device.CreateSurface(pWindow);
+	if (surface == VK_NULL_HANDLE)
+	{
+		return nullptr;
+	}
+
+	// Windows are presented on Unity's graphics queue, there is no other queue to fall back to.
+	const UnityVulkanInstance& instance = device.GetInstance();
+	VkBool32 supported = VK_FALSE;
+	device.vkGetPhysicalDeviceSurfaceSupportKHR(instance.physicalDevice, instance.queueFamilyIndex, surface, &supported);
+	if (supported != VK_TRUE)
+	{
+		Log("Unity's graphics queue cannot present to this window.");
+		device.vkDestroySurfaceKHR(instance.instance, surface, nullptr);
+		return nullptr;
+	}
+
+	return new VulkanSwapchain(device, surface);
+}
+
+// Command buffers come from the device's pool, which is only touched from the queue access callback.
+bool VulkanSwapchain::CreateFrames()
+{
+	const UnityVulkanInstance& instance = _device.GetInstance();
+
+	VkCommandBufferAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool = _device.GetCommandPool();
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	VkFenceCreateInfo fenceInfo = {};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	for (Frame& frame : _frames)
+	{
+		if (_device.vkAllocateCommandBuffers(instance.device, &allocateInfo, &frame.commandBuffer) != VK_SUCCESS
+			|| _device.vkCreateSemaphore(instance.device, &semaphoreInfo, nullptr, &frame.acquired) != VK_SUCCESS
+			|| _device.vkCreateFence(instance.device, &fenceInfo, nullptr, &frame.fence) != VK_SUCCESS)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+VkSurfaceFormatKHR VulkanSwapchain::ChooseFormat(VkFormat imageFormat) const
+{
+	const UnityVulkanInstance& instance = _device.GetInstance();
+	uint32_t formatCount = 0;
+	_device.vkGetPhysicalDeviceSurfaceFormatsKHR(instance.physicalDevice, _surface, &formatCount, nullptr);
+	std::vector<VkSurfaceFormatKHR> formats(formatCount);
+	_device.vkGetPhysicalDeviceSurfaceFormatsKHR(instance.physicalDevice, _surface, &formatCount, formats.data());
+
+	// Blits convert between sRGB and linear encodings, so the swapchain has to match Unity's or colours shift.
+	const bool srgb = IsSrgb(imageFormat);
+	VkSurfaceFormatKHR chosen = { srgb ? VK_FORMAT_B8G8R8A8_SRGB : VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+	for (auto it = formats.begin(); it != formats.end(); ++it)
+	{
+		if (it->format == VK_FORMAT_UNDEFINED)
+		{
+			// The surface takes any format.
+			return chosen;
+		}
+
+		const bool eightBit = it->format == VK_FORMAT_B8G8R8A8_UNORM || it->format == VK_FORMAT_B8G8R8A8_SRGB
+			|| it->format == VK_FORMAT_R8G8B8A8_UNORM || it->format == VK_FORMAT_R8G8B8A8_SRGB;
+		if (eightBit && IsSrgb(it->format) == srgb)
+		{
+			return *it;
+		}
+	}
+
+	return formats.empty() ? chosen : formats.front();
+}
+
+VkPresentModeKHR VulkanSwapchain::ChoosePresentMode(PresentMode presentMode) const
+{
+	// FIFO is the only mode every surface supports, and what each preference falls back to.
+	VkPresentModeKHR preferred[2] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR };
+	switch (presentMode)
+	{
+	case PresentModeImmediate:
+		// Mailbox never waits either, it only replaces tearing with a dropped frame.
+		preferred[0] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		preferred[1] = VK_PRESENT_MODE_MAILBOX_KHR;
+		break;
+	case PresentModeAdaptive:
+		preferred[0] = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+		break;
+	case PresentModeMailbox:
+		preferred[0] = VK_PRESENT_MODE_MAILBOX_KHR;
+		break;
+	default:
+		break;
+	}
+
+	const UnityVulkanInstance& instance = _device.GetInstance();
+	uint32_t modeCount = 0;
+	_device.vkGetPhysicalDeviceSurfacePresentModesKHR(instance.physicalDevice, _surface, &modeCount, nullptr);
+	std::vector<VkPresentModeKHR> modes(modeCount);
+	_device.vkGetPhysicalDeviceSurfacePresentModesKHR(instance.physicalDevice, _surface, &modeCount, modes.data());
+
+	for (VkPresentModeKHR mode : preferred)
+	{
+		if (std::find(modes.begin(), modes.end(), mode) != modes.end())
+		{
+			return mode;
+		}
+	}
+
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+PresentMode VulkanSwapchain::ToPresentMode(VkPresentModeKHR presentMode)
+{
+	switch (presentMode)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR:
+		return PresentModeImmediate;
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+		return PresentModeAdaptive;
+	case VK_PRESENT_MODE_MAILBOX_KHR:
+		return PresentModeMailbox;
+	default:
+		return PresentModeVsync;
+	}
+}
+
+PresentMode VulkanSwapchain::GetPresentMode() const
+{
+	return _presentMode;
+}
+
+int VulkanSwapchain::GetImageCount() const
+{
+	return int(_images.size());
+}
+
+bool VulkanSwapchain::IsSrgb(VkFormat format)
+{
+	return format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_A8B8G8R8_SRGB_PACK32;
+}
+
+bool VulkanSwapchain::CreateSwapchain(VkFormat imageFormat, int width, int height, PresentMode presentMode, int imageCount)
+{
+	const UnityVulkanInstance& instance = _device.GetInstance();
+
+	VkSurfaceCapabilitiesKHR capabilities;
+	if (_device.vkGetPhysicalDeviceSurfaceCapabilitiesKHR(instance.physicalDevice, _surface, &capabilities) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	if ((capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) == 0)
+	{
+		Log("Window surfaces cannot be blitted to on this device, windows will not be presented.");
+		_failed = true;
+		return false;
+	}
+
+	VkExtent2D extent = capabilities.currentExtent;
+	if (extent.width == UINT32_MAX)
+	{
+		extent.width = std::min(std::max(uint32_t(width), capabilities.minImageExtent.width), capabilities.maxImageExtent.width);
+		extent.height = std::min(std::max(uint32_t(height), capabilities.minImageExtent.height), capabilities.maxImageExtent.height);
+	}
+
+	// Minimised windows have no extent, the swapchain is created once they are restored.
+	if (extent.width == 0 || extent.height == 0)
+	{
+		return false;
+	}
+
+	uint32_t minImageCount = imageCount > 0 ? std::max(uint32_t(imageCount), capabilities.minImageCount) : capabilities.minImageCount + 1;
+	if (capabilities.maxImageCount > 0)
+	{
+		minImageCount = std::min(minImageCount, capabilities.maxImageCount);
+	}
+
+	const VkCompositeAlphaFlagBitsKHR compositeAlphaModes[] = {
+		VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+		VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
+		VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR,
+		VK_COMPOSITE_ALPHA_POST_MULTIPLIED_BIT_KHR
+	};
+	VkCompositeAlphaFlagBitsKHR compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	for (auto mode : compositeAlphaModes)
+	{
+		if (capabilities.supportedCompositeAlpha & mode)
+		{
+			compositeAlpha = mode;
+			break;
+		}
+	}
+
+	const VkSurfaceFormatKHR format = ChooseFormat(imageFormat);
+	const VkPresentModeKHR vulkanPresentMode = ChoosePresentMode(presentMode);
+
+	VkSwapchainCreateInfoKHR createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	createInfo.surface = _surface;
+	createInfo.minImageCount = minImageCount;
+	createInfo.imageFormat = format.format;
+	createInfo.imageColorSpace = format.colorSpace;
+	createInfo.imageExtent = extent;
+	createInfo.imageArrayLayers = 1;
+	createInfo.imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	createInfo.preTransform = capabilities.currentTransform;
+	createInfo.compositeAlpha = compositeAlpha;
+	createInfo.presentMode = vulkanPresentMode;
+	createInfo.clipped = VK_TRUE;
+	createInfo.oldSwapchain = _swapchain;
+
+	// The old swapchain's images and semaphores may still be used by queued presents. Waiting for the whole queue is
+	// allowed here as this runs inside Unity's queue access, and only happens when a window is resized or its present mode changes.
+	if (_swapchain != VK_NULL_HANDLE)
+	{
+		_device.vkQueueWaitIdle(instance.graphicsQueue);
+	}
+
+	VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+	const VkResult result = _device.vkCreateSwapchainKHR(instance.device, &createInfo, nullptr, &swapchain);
+
+	// The old swapchain is retired even if creating the new one failed.
+	if (_swapchain != VK_NULL_HANDLE)
+	{
+		_device.vkDestroySwapchainKHR(instance.device, _swapchain, nullptr);
+		_swapchain = VK_NULL_HANDLE;
+	}
+	DestroyRenderedSemaphores();
+	_images.clear();
+
+	if (result != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	_swapchain = swapchain;
+
+	uint32_t swapchainImageCount = 0;
+	_device.vkGetSwapchainImagesKHR(instance.device, _swapchain, &swapchainImageCount, nullptr);
+	_images.resize(swapchainImageCount);
+	_device.vkGetSwapchainImagesKHR(instance.device, _swapchain, &swapchainImageCount, _images.data());
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	_rendered.resize(swapchainImageCount, VK_NULL_HANDLE);
+	for (auto it = _rendered.begin(); it != _rendered.end(); ++it)
+	{
+		_device.vkCreateSemaphore(instance.device, &semaphoreInfo, nullptr, &*it);
+	}
+
+	_extent = extent;
+	_width = width;
+	_height = height;
+	_requestedPresentMode = presentMode;
+	_requestedImageCount = imageCount;
+	_presentMode = ToPresentMode(vulkanPresentMode);
+	_outOfDate = false;
+	return true;
+}
+
+void VulkanSwapchain::DestroyRenderedSemaphores()
+{
+	const VkDevice device = _device.GetInstance().device;
+	for (auto it = _rendered.begin(); it != _rendered.end(); ++it)
+	{
+		_device.vkDestroySemaphore(device, *it, nullptr);
+	}
+	_rendered.clear();
+}
+
+void VulkanSwapchain::RecordBlit(VkCommandBuffer commandBuffer, const UnityVulkanImage& image, int contentWidth, int contentHeight, VkImage target) const
+{
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = target;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+
+	// The previous contents are overwritten, and the transfer stage waits for the acquire semaphore.
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	_device.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	// Unity's render textures are stored bottom row first on every API, so the blit flips them to Vulkan's top-left origin.
+	VkImageBlit region = {};
+	region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.srcSubresource.layerCount = 1;
+	region.srcOffsets[0] = { 0, contentHeight, 0 };
+	region.srcOffsets[1] = { contentWidth, 0, 1 };
+	region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.dstSubresource.layerCount = 1;
+	region.dstOffsets[0] = { 0, 0, 0 };
+	region.dstOffsets[1] = { int32_t(_extent.width), int32_t(_extent.height), 1 };
+
+	const bool scaled = uint32_t(contentWidth) != _extent.width || uint32_t(contentHeight) != _extent.height;
+	_device.vkCmdBlitImage(commandBuffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, target, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		1, &region, scaled ? VK_FILTER_LINEAR : VK_FILTER_NEAREST);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	_device.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+bool VulkanSwapchain::Present(const UnityVulkanImage& image, int contentWidth, int contentHeight, int width, int height, PresentMode presentMode, int imageCount)
+{
+	if (_failed || width <= 0 || height <= 0 || contentWidth <= 0 || contentHeight <= 0)
+	{
+		return false;
+	}
+
+	if (_frames[0].fence == VK_NULL_HANDLE && !CreateFrames())
+	{
+		Log("Could not create the command buffers to present a window with.");
+		_failed = true;
+		return false;
+	}
+
+	const bool modeChanged = presentMode != _requestedPresentMode || imageCount != _requestedImageCount;
+	if ((_swapchain == VK_NULL_HANDLE || _outOfDate || modeChanged || width != _width || height != _height) && !CreateSwapchain(image.format, width, height, presentMode, imageCount))
+	{
+		return false;
+	}
+
+	const UnityVulkanInstance& instance = _device.GetInstance();
+	Frame& frame = _frames[_frameIndex];
+	_device.vkWaitForFences(instance.device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+
+	uint32_t imageIndex = 0;
+	VkResult result = _device.vkAcquireNextImageKHR(instance.device, _swapchain, UINT64_MAX, frame.acquired, VK_NULL_HANDLE, &imageIndex);
+	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		_outOfDate = true;
+		return false;
+	}
+	if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+	{
+		return false;
+	}
+
+	_device.vkResetFences(instance.device, 1, &frame.fence);
+	_device.vkResetCommandBuffer(frame.commandBuffer, 0);
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	_device.vkBeginCommandBuffer(frame.commandBuffer, &beginInfo);
+	RecordBlit(frame.commandBuffer, image, contentWidth, contentHeight, _images[imageIndex]);
+	_device.vkEndCommandBuffer(frame.commandBuffer);
+
+	const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.pWaitSemaphores = &frame.acquired;
+	submitInfo.pWaitDstStageMask = &waitStage;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &frame.commandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &_rendered[imageIndex];
+	if (_device.vkQueueSubmit(instance.graphicsQueue, 1, &submitInfo, frame.fence) != VK_SUCCESS)
+	{
+		// Only happens when the device is lost, the fence would never be signalled again.
+		Log("Submitting a window present failed, the window will not be presented again.");
+		_failed = true;
+		return false;
+	}
+
+	VkPresentInfoKHR presentInfo = {};
+	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.waitSemaphoreCount = 1;
+	presentInfo.pWaitSemaphores = &_rendered[imageIndex];
+	presentInfo.swapchainCount = 1;
+	presentInfo.pSwapchains = &_swapchain;
+	presentInfo.pImageIndices = &imageIndex;
+	result = _device.vkQueuePresentKHR(instance.graphicsQueue, &presentInfo);
+
+	_frameIndex = (_frameIndex + 1) % FramesInFlight;
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+	{
+		_outOfDate = true;
+	}
+
+	return result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR;
+}
+
+// Only destroyed through VulkanDevice::Retire, once the queue is idle and nothing queued uses the frames anymore.
+VulkanSwapchain::~VulkanSwapchain()
+{
+	const UnityVulkanInstance& instance = _device.GetInstance();
+	DestroyRenderedSemaphores();
+
+	for (Frame& frame : _frames)
+	{
+		if (frame.commandBuffer != VK_NULL_HANDLE)
+		{
+			_device.vkFreeCommandBuffers(instance.device, _device.GetCommandPool(), 1, &frame.commandBuffer);
+		}
+		if (frame.acquired != VK_NULL_HANDLE)
+		{
+			_device.vkDestroySemaphore(instance.device, frame.acquired, nullptr);
+		}
+		if (frame.fence != VK_NULL_HANDLE)
+		{
+			_device.vkDestroyFence(instance.device, frame.fence, nullptr);
+		}
+	}
+
+	if (_swapchain != VK_NULL_HANDLE)
+	{
+		_device.vkDestroySwapchainKHR(instance.device, _swapchain, nullptr);
+	}
+
+	_device.vkDestroySurfaceKHR(instance.instance, _surface, nullptr);
+}
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "VulkanDevice.h"
+#include <vector>
+
+enum PresentMode : int;
+
+// The Vulkan counterpart of a window's GL drawable. The surface is created with the window on the event pump thread,
+// the swapchain on the first present. Present runs inside Unity's queue access, on whichever thread Unity submits from.
+class VulkanSwapchain
+{
+public:
+	// Returns nullptr if no surface could be created for the window.
+	static VulkanSwapchain* Create(VulkanDevice& device, SDL_Window* pWindow);
+	~VulkanSwapchain();
+
+	// Blits the bottom-left content rectangle of an image Unity left in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL to the next
+	// swapchain image and queues it for presentation. Returns false if nothing was presented. The swapchain is recreated
+	// whenever the present mode or image count asked for changes, zero images leaves the count to the driver.
+	bool Present(const UnityVulkanImage& image, int contentWidth, int contentHeight, int width, int height, PresentMode presentMode, int imageCount);
+	// What the swapchain was created with, which falls back from what was asked for where the surface does not support it.
+	// Zero images until a swapchain has been created.
+	PresentMode GetPresentMode() const;
+	int GetImageCount() const;
+
+private:
+	VulkanSwapchain(VulkanDevice& device, VkSurfaceKHR surface);
+
+	bool CreateFrames();
+	bool CreateSwapchain(VkFormat imageFormat, int width, int height, PresentMode presentMode, int imageCount);
+	void DestroyRenderedSemaphores();
+	VkSurfaceFormatKHR ChooseFormat(VkFormat imageFormat) const;
+	VkPresentModeKHR ChoosePresentMode(PresentMode presentMode) const;
+	void RecordBlit(VkCommandBuffer commandBuffer, const UnityVulkanImage& image, int contentWidth, int contentHeight, VkImage target) const;
+
+	static bool IsSrgb(VkFormat format);
+	static PresentMode ToPresentMode(VkPresentModeKHR presentMode);
+
+	struct Frame
+	{
+		VkCommandBuffer commandBuffer;
+		VkSemaphore acquired;
+		VkFence fence;
+	};
+
+	static const int FramesInFlight = 2;
+
+	VulkanDevice& _device;
+	VkSurfaceKHR _surface;
+	VkSwapchainKHR _swapchain;
+	VkExtent2D _extent;
+	int _width;
+	int _height;
+	PresentMode _requestedPresentMode;
+	int _requestedImageCount;
+	PresentMode _presentMode;
+	bool _outOfDate;
+	bool _failed;
+	std::vector<VkImage> _images;
+	// One per swapchain image rather than per frame, presentation holds on to it until that image is acquired again.
+	std::vector<VkSemaphore> _rendered;
+	Frame _frames[FramesInFlight];
+	int _frameIndex;
+};
@@ -0,0 +1,129 @@
+#ifdef _WIN32
+#include "GLPlatform.h"
+#include <GL/glew.h>
+#include <GL/wglew.h>
+#include "SDL_syswm.h"
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+class WGLPlatform : public GLPlatform
+{
+public:
+	explicit WGLPlatform(HGLRC unityContext)
+		: _unityContext(unityContext)
+		, _unityDeviceContext(nullptr)
+	{
+	}
+
+	const char* Name() const override
+	{
+		return "WGL";
+	}
+
+	PlatformDrawable CreateDrawable(SDL_Window* pWindow) override
+	{
+		SDL_SysWMinfo info;
+		SDL_VERSION(&info.version);
+		if (!SDL_GetWindowWMInfo(pWindow, &info))
+		{
+			return nullptr;
+		}
+
+		// SDL owns the window's device context, it stays valid until the window is destroyed.
+		return info.info.win.hdc;
+	}
+
+	void DestroyDrawable(PlatformDrawable /*drawable*/) override
+	{
+	}
+
+	void BeginPresent() override
+	{
+		_unityDeviceContext = wglGetCurrentDC();
+	}
+
+	bool MakeUnityContextCurrent(PlatformDrawable drawable) override
+	{
+		return wglMakeCurrent(HDC(drawable), _unityContext) != FALSE;
+	}
+
+	void EndPresent() override
+	{
+		wglMakeCurrent(_unityDeviceContext, _unityContext);
+	}
+
+	PlatformContext CreateSharedContext(PlatformDrawable drawable, bool debug) override
+	{
+		if (!WGLEW_ARB_create_context)
+		{
+			return nullptr;
+		}
+
+		GLint majorVersion, minorVersion;
+		glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+		glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+		const int attributes[] = {
+			WGL_CONTEXT_MAJOR_VERSION_ARB, majorVersion,
+			WGL_CONTEXT_MINOR_VERSION_ARB, minorVersion,
+			WGL_CONTEXT_PROFILE_MASK_ARB, WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
+			WGL_CONTEXT_FLAGS_ARB, debug ? WGL_CONTEXT_DEBUG_BIT_ARB : 0,
+			0
+		};
+
+		return wglCreateContextAttribsARB(HDC(drawable), _unityContext, attributes);
+	}
+
+	bool MakeCurrent(PlatformDrawable drawable, PlatformContext context) override
+	{
+		return wglMakeCurrent(HDC(drawable), HGLRC(context)) != FALSE;
+	}
+
+	void ReleaseCurrent() override
+	{
+		wglMakeCurrent(nullptr, nullptr);
+	}
+
+	void DestroyContext(PlatformContext context) override
+	{
+		wglDeleteContext(HGLRC(context));
+	}
+
+	void SwapBuffers(PlatformDrawable drawable) override
+	{
+		::SwapBuffers(HDC(drawable));
+	}
+
+	// The interval belongs to the window of the current context, so Unity's own window is not affected.
+	int SetSwapInterval(PlatformDrawable /*drawable*/, int interval) override
+	{
+		if (!WGLEW_EXT_swap_control)
+		{
+			return 1;
+		}
+
+		if (interval < 0 && !WGLEW_EXT_swap_control_tear)
+		{
+			interval = 1;
+		}
+
+		wglSwapIntervalEXT(interval);
+		return wglGetSwapIntervalEXT();
+	}
+
+private:
+	const HGLRC _unityContext;
+	HDC _unityDeviceContext;
+};
+
+GLPlatform* CreateWGLPlatform()
+{
+	const HGLRC unityContext = wglGetCurrentContext();
+	if (unityContext == nullptr)
+	{
+		return nullptr;
+	}
+
+	return new WGLPlatform(unityContext);
+}
+#endif
@@ -1,37 +1,104 @@
 #include "UnityInterface.h"
 #include "Window.h"
+#include "Presenter.h"
+#include "GLStateCache.h"
+#include "GpuTimer.h"
+#include "GLPlatform.h"
+#ifdef WINDOW_PLUGIN_VULKAN
+#include "VulkanSwapchain.h"
+#endif
+#include "Profiler.h"
 #include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#ifdef _WIN32
 #include "SDL_syswm.h"
 #include <CommCtrl.h>
+#include <dwmapi.h>
+#endif
 
-CloseFunction Window::CloseDelegate = nullptr;
-ResizeFunction Window::ResizeDelegate = nullptr;
-MouseUpdateFuncton Window::MouseDelegate = nullptr;
-MoveFunction Window::MoveDelegate = nullptr;
+enum HiddenReason : unsigned int
+{
+	HiddenMinimized = 1,
+	HiddenUnmapped = 2,
+	// No part of the window is on any display.
+	HiddenOffScreen = 4,
+	// Windows only, the compositor hides the window, e.g. when it is on another virtual desktop.
+	HiddenCloaked = 8
+};
+
+WindowEventQueue Window::Events;
+WindowInputTable Window::Inputs;
 
 GLuint Window::_vao = 0;
 GLuint Window::_vbo = 0;
 GLuint Window::_ebo = 0;
-GLuint Window::_fragmentShader = 0;
+GLuint Window::_fragmentShaders[UpscaleModeCount] = {};
 GLuint Window::_vertexShader = 0;
-GLuint Window::_shaderProgram = 0;
+GLuint Window::_shaderPrograms[UpscaleModeCount] = {};
+GLuint Window::_sampler = 0;
+GLuint Window::_readFramebuffer = 0;
 
-Window::Window(std::string title, HGLRC unityContext, int width, int height, bool resizable, GLuint textureHandle)
+Window::Window(std::string title, GLPlatform* pPlatform, VulkanDevice* pVulkanDevice, int width, int height, float renderScale, bool resizable, void* nativeTexture)
 	: ID(0)
+	, Handle(0)
 	, _pWindow(nullptr)
-	, _unityContext(unityContext)
-	, _deviceContext(nullptr)
-	, _pTextureHandle(textureHandle)
+	, _pPlatform(pPlatform)
+	, _drawable(nullptr)
+	, _pVulkanDevice(pVulkanDevice)
+	, _pSwapchain(nullptr)
 	, _title(std::move(title))
+	, _pNativeTexture(nativeTexture)
+	, _contentWidth(ScaledSize(width, ClampRenderScale(renderScale)))
+	, _contentHeight(ScaledSize(height, ClampRenderScale(renderScale)))
 	, _width(width)
 	, _height(height)
+	, _renderScale(ClampRenderScale(renderScale))
+	, _upscaleMode(UpscaleBilinear)
+	, _presentMode(PresentModeVsync)
+	, _bufferCount(0)
+	, _activePresentMode(PresentModeVsync)
+	, _activeBufferCount(0)
+	, _renderThreadPresentMode(-1)
 	, _resizable(resizable)
-	, _focused(false)
+	, _pNativeWindow(nullptr)
+	, _inputSlot(Inputs.Allocate())
+	, _pInput(nullptr)
+	, _unmappedInput()
+	, _eventRing()
+	, _resizePending(false)
+	, _resizeTicks(0)
+	, _hiddenReasons(0)
+	, _visible(true)
+	, _presentInterval(0)
+	, _nextPresentTime()
+	, _lastScheduledTime()
+	, _schedule(PresentScheduled)
+	, _presentTicket(true)
+	, _pPresenter(nullptr)
+	, _presenterFailed(false)
+	, _refreshRate(0)
+	, _dirtyTracking(false)
+	, _frameVersion(1)
+	, _presentedVersion(0)
+	, _presentCount(0)
+	, _skippedPresentCount(0)
+	, _deferredPresentCount(0)
+	, _createdTime(std::chrono::steady_clock::now())
+	, _firstPresentMilliseconds(-1.0f)
+	, _textureReadyTime()
+	, _stats()
+	, _texture()
+	, _presentPath(PresentPathNone)
 {
+	_pInput = _inputSlot >= 0 ? Inputs.Get(_inputSlot) : &_unmappedInput;
 }
 
 #ifdef _WIN32
+// Event pump thread only, like every message sent to the windows.
 HWND _draggedWindow = nullptr;
+DWORD _dragInputThread = 0;
 LRESULT CALLBACK SubClassProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData)
 {
 	const HWND unityWindow = GetUnityWindowHandle();
@@ -42,6 +109,7 @@ LRESULT CALLBACK SubClassProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam
 		if (_draggedWindow != nullptr)
 		{
 			ReleaseCapture();
+			AttachThreadInput(GetCurrentThreadId(), _dragInputThread, FALSE);
 			_draggedWindow = nullptr;
 		}
 	case WM_KEYDOWN:
@@ -81,40 +149,67 @@ LRESULT CALLBACK SubClassProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam
 }
 #endif
 
-bool Window::CreateContext()
+// Event pump thread, the SDL window belongs to the thread that pumps its messages.
+bool Window::CreateContext(SDL_Window* pPooledWindow)
 {
-	unsigned int windowFlags = SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN;
-	if (_resizable)
+	if (pPooledWindow != nullptr)
 	{
-		windowFlags |= SDL_WINDOW_RESIZABLE;
+		// Pooled windows already have their pixel format, they only need to look like the requested one.
+		_pWindow = pPooledWindow;
+		SDL_SetWindowTitle(_pWindow, _title.c_str());
+		SDL_SetWindowSize(_pWindow, _width, _height);
+		SDL_SetWindowResizable(_pWindow, _resizable ? SDL_TRUE : SDL_FALSE);
+		SDL_ShowWindow(_pWindow);
 	}
-
-	_pWindow = SDL_CreateWindow(_title.c_str(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, _width, _height, windowFlags);
-	if (_pWindow == nullptr)
+	else
 	{
-		return false;
+		unsigned int windowFlags = (_pVulkanDevice != nullptr ? SDL_WINDOW_VULKAN : SDL_WINDOW_OPENGL) | SDL_WINDOW_SHOWN;
+		if (_resizable)
+		{
+			windowFlags |= SDL_WINDOW_RESIZABLE;
+		}
+
+		_pWindow = SDL_CreateWindow(_title.c_str(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, _width, _height, windowFlags);
+		if (_pWindow == nullptr)
+		{
+			return false;
+		}
 	}
 
-	SDL_SysWMinfo info;
-	SDL_VERSION(&info.version);
-	SDL_GetWindowWMInfo(_pWindow, &info);
-	_deviceContext = info.info.win.hdc;
+	if (_pPlatform != nullptr)
+	{
+		_drawable = _pPlatform->CreateDrawable(_pWindow);
+		// Every window is created double-buffered to match Unity's context, GL has no say in the count beyond that.
+		_activeBufferCount = 2;
+	}
+#ifdef WINDOW_PLUGIN_VULKAN
+	else if (_pVulkanDevice != nullptr)
+	{
+		_pSwapchain = VulkanSwapchain::Create(*_pVulkanDevice, _pWindow);
+		if (_pSwapchain == nullptr)
+		{
+			Log("Window '" + _title + "' cannot be presented with Vulkan.");
+		}
+	}
+#endif
 	
 	ID = SDL_GetWindowID(_pWindow);
+	UpdateRefreshRate(QueryRefreshRate());
 
 #ifdef _WIN32
+	SDL_SysWMinfo info;
+	SDL_VERSION(&info.version);
+	SDL_GetWindowWMInfo(_pWindow, &info);
 	SetWindowSubclass(info.info.win.window, &SubClassProc, 1, 0);
+	_pNativeWindow = info.info.win.window;
 #endif
 
+	GetEventPump().Register(this);
 	return true;
 }
 
 void Window::LoadResources()
 {
-	// Create Vertex Array Object
-	glGenVertexArrays(1, &_vao);
-	glBindVertexArray(_vao);
-
 	// Create a Vertex Buffer Object and copy the vertex data to it
 	glGenBuffers(1, &_vbo);
 
@@ -129,7 +224,7 @@ void Window::LoadResources()
 	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-	// Create an element array
+	// Create an element array, uploaded through GL_ARRAY_BUFFER as the element binding belongs to whichever VAO is bound
 	glGenBuffers(1, &_ebo);
 
 	GLuint elements[] = {
@@ -137,23 +232,25 @@ void Window::LoadResources()
 		2, 3, 0
 	};
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements), elements, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, _ebo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(elements), elements, GL_STATIC_DRAW);
 
 	// Shader sources
 	const GLchar* vertexSource = R"glsl(
 		#version 150 core
 		in vec2 position;
 		in vec2 texcoord;
+		in vec2 texcoordScale;
 		out vec2 Texcoord;
 		void main()
 		{
-			Texcoord = texcoord;
+			Texcoord = texcoord * texcoordScale;
 			gl_Position = vec4(position, 0.0, 1.0);
 		}
 	)glsl";
 
-	const GLchar* fragmentSource = R"glsl(
+	const GLchar* fragmentSources[UpscaleModeCount] = {
+		R"glsl(
 		#version 150 core
 		in vec2 Texcoord;
 		out vec4 outColor;
@@ -162,78 +259,482 @@ void Window::LoadResources()
 		{
 			outColor = texture(tex, Texcoord);
 		}
-	)glsl";
+	)glsl",
+		R"glsl(
+		#version 150 core
+		in vec2 Texcoord;
+		out vec4 outColor;
+		uniform sampler2D tex;
+		void main()
+		{
+			vec2 texel = 1.0 / vec2(textureSize(tex, 0));
+			vec4 center = texture(tex, Texcoord);
+			vec3 north = texture(tex, Texcoord + vec2(0.0, texel.y)).rgb;
+			vec3 south = texture(tex, Texcoord - vec2(0.0, texel.y)).rgb;
+			vec3 east = texture(tex, Texcoord + vec2(texel.x, 0.0)).rgb;
+			vec3 west = texture(tex, Texcoord - vec2(texel.x, 0.0)).rgb;
+
+			// Sharpen less where the neighbourhood already spans most of the range, so hard edges don't ring.
+			vec3 minimum = min(center.rgb, min(min(north, south), min(east, west)));
+			vec3 maximum = max(center.rgb, max(max(north, south), max(east, west)));
+			vec3 amount = sqrt(clamp(min(minimum, 1.0 - maximum) / max(maximum, 0.0001), 0.0, 1.0));
+			vec3 weight = amount * -0.2;
+
+			vec3 color = (center.rgb + (north + south + east + west) * weight) / (1.0 + 4.0 * weight);
+			outColor = vec4(clamp(color, 0.0, 1.0), center.a);
+		}
+	)glsl"
+	};
 
 	// Create and compile the vertex shader
 	_vertexShader = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(_vertexShader, 1, &vertexSource, nullptr);
 	glCompileShader(_vertexShader);
 
-	// Create and compile the fragment shader
-	_fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(_fragmentShader, 1, &fragmentSource, nullptr);
-	glCompileShader(_fragmentShader);
+	// The sampler unit never changes, so set it once rather than per present.
+	GLint previousProgram;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+
+	// One program per upscale mode, as uniforms belong to the program and presenter threads share it.
+	for (int mode = 0; mode < UpscaleModeCount; ++mode)
+	{
+		// Create and compile the fragment shader
+		_fragmentShaders[mode] = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(_fragmentShaders[mode], 1, &fragmentSources[mode], nullptr);
+		glCompileShader(_fragmentShaders[mode]);
+
+		// Link the vertex and fragment shader into a shader program
+		_shaderPrograms[mode] = glCreateProgram();
+		glAttachShader(_shaderPrograms[mode], _vertexShader);
+		glAttachShader(_shaderPrograms[mode], _fragmentShaders[mode]);
+		glBindFragDataLocation(_shaderPrograms[mode], 0, "outColor");
+		glBindAttribLocation(_shaderPrograms[mode], PositionAttribute, "position");
+		glBindAttribLocation(_shaderPrograms[mode], TexcoordAttribute, "texcoord");
+		glBindAttribLocation(_shaderPrograms[mode], GLStateCache::TexcoordScaleAttribute, "texcoordScale");
+		glLinkProgram(_shaderPrograms[mode]);
+
+		glUseProgram(_shaderPrograms[mode]);
+		glUniform1i(glGetUniformLocation(_shaderPrograms[mode], "tex"), 0);
+	}
+
+	glUseProgram(previousProgram);
+
+	// Sample Unity's textures through our own sampler instead of changing their parameters.
+	glGenSamplers(1, &_sampler);
+	glSamplerParameteri(_sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glSamplerParameteri(_sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glSamplerParameteri(_sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glSamplerParameteri(_sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// Framebuffer objects are not shared between contexts, presenter threads create their own.
+	glGenFramebuffers(1, &_readFramebuffer);
+
+	_vao = CreateVertexArray();
+}
+
+GLuint Window::CreateVertexArray()
+{
+	GLint previousVao;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVao);
 
-	// Link the vertex and fragment shader into a shader program
-	_shaderProgram = glCreateProgram();
-	glAttachShader(_shaderProgram, _vertexShader);
-	glAttachShader(_shaderProgram, _fragmentShader);
-	glBindFragDataLocation(_shaderProgram, 0, "outColor");
-	glLinkProgram(_shaderProgram);
+	GLuint vao;
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
 
 	// Specify the layout of the vertex data
-	const GLint posAttrib = glGetAttribLocation(_shaderProgram, "position");
-	glEnableVertexAttribArray(posAttrib);
-	glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
+	glEnableVertexAttribArray(PositionAttribute);
+	glVertexAttribPointer(PositionAttribute, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
 
-	const GLint texAttrib = glGetAttribLocation(_shaderProgram, "texcoord");
-	glEnableVertexAttribArray(texAttrib);
-	glVertexAttribPointer(texAttrib, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)(2 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(TexcoordAttribute);
+	glVertexAttribPointer(TexcoordAttribute, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)(2 * sizeof(GLfloat)));
+
+	glBindVertexArray(previousVao);
+	return vao;
 }
 
+
 void Window::UnloadResources()
 {
-	glDeleteProgram(_shaderProgram);
-	glDeleteShader(_fragmentShader);
+	glDeleteFramebuffers(1, &_readFramebuffer);
+	glDeleteSamplers(1, &_sampler);
+	for (int mode = 0; mode < UpscaleModeCount; ++mode)
+	{
+		glDeleteProgram(_shaderPrograms[mode]);
+		glDeleteShader(_fragmentShaders[mode]);
+	}
 	glDeleteShader(_vertexShader);
 	glDeleteBuffers(1, &_ebo);
 	glDeleteBuffers(1, &_vbo);
 	glDeleteVertexArrays(1, &_vao);
 }
 
-void Window::HandleEvent(const SDL_Event& event)
+void Window::HandleEvent(const QueuedEvent& queued)
 {
+	const SDL_Event& event = queued.event;
 	switch (event.window.event)
 	{
 	case SDL_WINDOWEVENT_SIZE_CHANGED:
+		// The old texture is presented stretched until UpdateResize asks Unity for a new one.
 		_width = event.window.data1;
 		_height = event.window.data2;
-		_pTextureHandle = GLuint(ResizeDelegate(this, _width, _height));
+		_resizePending = true;
+		_resizeTicks = event.window.timestamp;
+		_hiddenReasons = queued.offScreen ? _hiddenReasons | HiddenOffScreen : _hiddenReasons & ~HiddenOffScreen;
+		MarkDirty();
+		break;
+	case SDL_WINDOWEVENT_EXPOSED:
+		MarkDirty();
+		break;
+	case SDL_WINDOWEVENT_MINIMIZED:
+		_hiddenReasons |= HiddenMinimized;
+		break;
+	case SDL_WINDOWEVENT_MAXIMIZED:
+	case SDL_WINDOWEVENT_RESTORED:
+		_hiddenReasons &= ~HiddenMinimized;
+		break;
+	case SDL_WINDOWEVENT_HIDDEN:
+		_hiddenReasons |= HiddenUnmapped;
+		break;
+	case SDL_WINDOWEVENT_SHOWN:
+		_hiddenReasons &= ~HiddenUnmapped;
 		break;
 	case SDL_WINDOWEVENT_FOCUS_GAINED:
-		_focused = true;
+		_pInput->focused = 1;
+		++_pInput->sequence;
 		break;
 	case SDL_WINDOWEVENT_FOCUS_LOST:
-		_focused = false;
+		// Releases are not delivered to a window that lost focus, so nothing may stay held.
+		_pInput->focused = 0;
+		_pInput->buttons = 0;
+		_pInput->modifiers = 0;
+		std::fill(_pInput->keys, _pInput->keys + InputKeyWords, 0u);
+		++_pInput->sequence;
 		break;
-#ifdef _WIN32
 	case SDL_WINDOWEVENT_MOVED:
+		UpdateRefreshRate(queued.refreshRate);
+		_hiddenReasons = queued.offScreen ? _hiddenReasons | HiddenOffScreen : _hiddenReasons & ~HiddenOffScreen;
+#ifdef _WIN32
 		RECT rect;
 		POINT cursor;
 		if (GetCursorPos(&cursor) && GetWindowRect(GetUnityWindowHandle(), &rect))
 		{
 			const int insetPixels = 10;
 			const bool cursorInsideUnityWindow = cursor.x >= rect.left + insetPixels && cursor.x < rect.right - insetPixels && cursor.y >= rect.top + insetPixels && cursor.y < rect.bottom + insetPixels;
-			MoveDelegate(this, cursor.x, cursor.y, cursorInsideUnityWindow);
+			Events.Push(Handle, WindowEventMove, cursor.x, cursor.y, cursorInsideUnityWindow ? 1 : 0);
 		}
-		break;
+#else
+		// Unity's window cannot be located here, so moving a window never docks it.
+		Events.Push(Handle, WindowEventMove, queued.cursorX, queued.cursorY, 0);
 #endif
+		break;
 	case SDL_WINDOWEVENT_CLOSE:
-		CloseDelegate(this);
+		Events.Push(Handle, WindowEventClose, 0, 0, 0);
 		break;
 	}
 }
 
+// Called from the SDL event watch as soon as the event is raised, which can be inside a modal move/size loop.
+void Window::Expose(const SDL_Event& event)
+{
+	std::lock_guard<std::mutex> lock(_presenterMutex);
+	if (_pPresenter == nullptr)
+	{
+		return;
+	}
+
+	if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+	{
+		_pPresenter->Expose(event.window.data1, event.window.data2);
+	}
+	else
+	{
+		_pPresenter->Expose(_width, _height);
+	}
+}
+
+// Pump thread. Zero if the display's mode is unknown.
+int Window::QueryRefreshRate() const
+{
+	SDL_DisplayMode mode;
+	const int displayIndex = SDL_GetWindowDisplayIndex(_pWindow);
+	if (displayIndex < 0 || SDL_GetCurrentDisplayMode(displayIndex, &mode) != 0)
+	{
+		return 0;
+	}
+
+	return mode.refresh_rate;
+}
+
+void Window::UpdateRefreshRate(int refreshRate)
+{
+	if (refreshRate <= 0 || refreshRate == _refreshRate)
+	{
+		return;
+	}
+
+	_refreshRate = refreshRate;
+
+	std::lock_guard<std::mutex> lock(_presenterMutex);
+	if (_pPresenter != nullptr)
+	{
+		_pPresenter->SetRefreshRate(_refreshRate);
+	}
+}
+
+// Asks Unity for a texture at the window size scaled by the render scale. The old texture is presented stretched until
+// managed code answers the resize event with SetTexture.
+void Window::ResizeTexture()
+{
+	const float renderScale = _renderScale;
+	Events.Push(Handle, WindowEventResize, ScaledSize(_width, renderScale), ScaledSize(_height, renderScale), 0);
+	_resizePending = false;
+}
+
+void Window::SetTexture(void* nativeTexture, int contentWidth, int contentHeight)
+{
+	ProfilerScope scope(ProfilerMarkerResize, ID, contentWidth, contentHeight, _presentPath);
+	_pNativeTexture = nativeTexture;
+	_contentWidth = contentWidth;
+	_contentHeight = contentHeight;
+	MarkDirty();
+}
+
+void Window::UpdateResize(unsigned int debounceMilliseconds)
+{
+	if (_resizePending && SDL_GetTicks() - _resizeTicks >= debounceMilliseconds)
+	{
+		ResizeTexture();
+	}
+}
+
+// Main thread, once per frame after ProcessEvents. Tells managed code when the window is hidden or shown again.
+void Window::UpdateVisibility()
+{
+#ifdef _WIN32
+	DWORD cloaked = 0;
+	if (_pNativeWindow != nullptr && SUCCEEDED(DwmGetWindowAttribute(HWND(_pNativeWindow), DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked != 0)
+	{
+		_hiddenReasons |= HiddenCloaked;
+	}
+	else
+	{
+		_hiddenReasons &= ~HiddenCloaked;
+	}
+#endif
+
+	const bool visible = _hiddenReasons == 0;
+	if (visible == _visible)
+	{
+		return;
+	}
+
+	_visible = visible;
+	Events.Push(Handle, WindowEventVisibility, 0, 0, visible ? 1 : 0);
+	{
+		std::lock_guard<std::mutex> lock(_presenterMutex);
+		if (_pPresenter != nullptr)
+		{
+			_pPresenter->SetVisible(visible);
+		}
+	}
+
+	// Whatever was last presented may be stale, and dirty tracking would otherwise wait for the next change.
+	if (visible)
+	{
+		MarkDirty();
+	}
+}
+
+// Main thread. Zero or less presents at Unity's frame rate.
+void Window::SetTargetRate(float rate)
+{
+	if (rate <= 0.0f)
+	{
+		_presentInterval = std::chrono::steady_clock::duration::zero();
+		return;
+	}
+
+	// Golden ratio steps spread the slots evenly over the period, however many windows share a rate.
+	_presentInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(1.0f / rate));
+	const float phase = std::fmod(float(Handle & 0xffffffff) * 0.618034f, 1.0f);
+	_nextPresentTime = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(_presentInterval * phase);
+}
+
+// Main thread. due receives when the window became due, so the scheduler can serve the longest waiting first.
+bool Window::IsPresentDue(std::chrono::steady_clock::time_point horizon, std::chrono::steady_clock::time_point& due) const
+{
+	if (!_visible)
+	{
+		return false;
+	}
+
+	due = _presentInterval == std::chrono::steady_clock::duration::zero() ? _lastScheduledTime : _nextPresentTime;
+	return due <= horizon;
+}
+
+bool Window::IsFocused() const
+{
+	return _pInput->focused != 0;
+}
+
+float Window::GetPresentCost() const
+{
+	return _stats.GetAverageCost();
+}
+
+void Window::SetSchedule(PresentSchedule schedule, std::chrono::steady_clock::time_point now)
+{
+	_schedule = schedule;
+	if (schedule == PresentDeferred)
+	{
+		++_deferredPresentCount;
+	}
+
+	if (schedule != PresentScheduled)
+	{
+		return;
+	}
+
+	_presentTicket = true;
+	_lastScheduledTime = now;
+	if (_presentInterval != std::chrono::steady_clock::duration::zero())
+	{
+		// Stays on the window's phase, unless it has fallen more than a period behind.
+		_nextPresentTime += _presentInterval;
+		if (_nextPresentTime <= now)
+		{
+			_nextPresentTime = now + _presentInterval;
+		}
+	}
+}
+
+PresentSchedule Window::GetSchedule() const
+{
+	return _schedule;
+}
+
+// Pump thread. Windows partly on a display still count as visible, SDL has no way to tell whether other windows cover them.
+bool Window::IsOffScreen() const
+{
+	SDL_Rect windowRect;
+	SDL_GetWindowPosition(_pWindow, &windowRect.x, &windowRect.y);
+	SDL_GetWindowSize(_pWindow, &windowRect.w, &windowRect.h);
+
+	bool anyDisplay = false;
+	const int displayCount = SDL_GetNumVideoDisplays();
+	for (int i = 0; i < displayCount; ++i)
+	{
+		SDL_Rect bounds;
+		if (SDL_GetDisplayBounds(i, &bounds) != 0)
+		{
+			continue;
+		}
+
+		if (SDL_HasIntersection(&windowRect, &bounds))
+		{
+			return false;
+		}
+		anyDisplay = true;
+	}
+
+	return anyDisplay;
+}
+
+int Window::ScaledSize(int size, float renderScale)
+{
+	return std::max(1, int(std::lround(size * renderScale)));
+}
+
+float Window::ClampRenderScale(float renderScale)
+{
+	return std::min(std::max(renderScale, 0.25f), 1.0f);
+}
+
+void Window::SetRenderScale(float renderScale)
+{
+	renderScale = ClampRenderScale(renderScale);
+	if (renderScale == _renderScale)
+	{
+		return;
+	}
+
+	_renderScale = renderScale;
+	ResizeTexture();
+}
+
+// Main thread. Applied by whichever thread presents the window next, zero buffers leaves the count to the driver.
+void Window::SetPresentMode(PresentMode mode, int bufferCount)
+{
+	if (mode < PresentModeImmediate || mode > PresentModeMailbox)
+	{
+		return;
+	}
+
+	_presentMode = mode;
+	_bufferCount = std::max(bufferCount, 0);
+	MarkDirty();
+}
+
+PresentMode Window::GetRequestedPresentMode() const
+{
+	return PresentMode(_presentMode.load());
+}
+
+void Window::GetPresentMode(PresentMode& mode, int& bufferCount)
+{
+	bufferCount = _activeBufferCount;
+
+	std::lock_guard<std::mutex> lock(_presenterMutex);
+	mode = _pPresenter != nullptr ? _pPresenter->GetPresentMode() : PresentMode(_activePresentMode.load());
+}
+
+// Only a presenter thread can wait for vblank without holding up Unity, mailbox swaps on vblank there and immediately
+// on the render thread, which is only reached when no presenter could be started.
+int Window::GetSwapInterval(PresentMode mode, bool presenterThread)
+{
+	switch (mode)
+	{
+	case PresentModeImmediate:
+		return 0;
+	case PresentModeAdaptive:
+		return -1;
+	case PresentModeMailbox:
+		return presenterThread ? 1 : 0;
+	default:
+		return 1;
+	}
+}
+
+PresentMode Window::GetSwapMode(int swapInterval, PresentMode requested, bool presenterThread)
+{
+	if (swapInterval == 0)
+	{
+		return PresentModeImmediate;
+	}
+
+	if (swapInterval < 0)
+	{
+		return PresentModeAdaptive;
+	}
+
+	return requested == PresentModeMailbox && presenterThread ? PresentModeMailbox : PresentModeVsync;
+}
+
+void Window::SetUpscaleMode(UpscaleMode mode)
+{
+	if (mode < 0 || mode >= UpscaleModeCount)
+	{
+		return;
+	}
+
+	_upscaleMode = mode;
+	MarkDirty();
+}
+
+// Event pump thread, like CreateContext and Drag.
 void Window::SetPosition(int x, int y) const
 {
 	SDL_SetWindowPosition(_pWindow, x, y);
@@ -241,56 +742,394 @@ void Window::SetPosition(int x, int y) const
 
 void Window::Drag() const
 {
+#ifdef _WIN32
 	SDL_SysWMinfo info;
 	SDL_VERSION(&info.version);
 	SDL_GetWindowWMInfo(_pWindow, &info);
 	_draggedWindow = info.info.win.window;
+	// The button went down in Unity's window, which belongs to another thread. Capturing the mouse from this one
+	// needs its input state until the button is released.
+	_dragInputThread = GetWindowThreadProcessId(GetUnityWindowHandle(), nullptr);
+	AttachThreadInput(GetCurrentThreadId(), _dragInputThread, TRUE);
 	SetCapture(_draggedWindow);
+#endif
 }
 
-void Window::Render()
+void Window::HandleInput(const SDL_Event& event)
 {
-	if (_pWindow == nullptr)
+	WindowInputState& input = *_pInput;
+	// Report the cursor in texture pixels, which is what Unity's cameras and canvases see.
+	const float renderScale = _renderScale;
+	switch (event.type)
+	{
+	case SDL_MOUSEMOTION:
+		input.cursorX = int(event.motion.x * renderScale);
+		input.cursorY = int((_height - event.motion.y) * renderScale);
+		input.buttons = event.motion.state;
+		break;
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+		input.cursorX = int(event.button.x * renderScale);
+		input.cursorY = int((_height - event.button.y) * renderScale);
+		if (event.button.state == SDL_PRESSED)
+		{
+			input.buttons |= SDL_BUTTON(event.button.button);
+		}
+		else
+		{
+			input.buttons &= ~SDL_BUTTON(event.button.button);
+		}
+		break;
+	case SDL_MOUSEWHEEL:
 	{
+		const int direction = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -1 : 1;
+		input.wheelX += event.wheel.x * direction;
+		input.wheelY += event.wheel.y * direction;
+		break;
+	}
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+	{
+		const unsigned int scancode = event.key.keysym.scancode;
+		if (scancode < InputKeyWords * 32u)
+		{
+			const unsigned int bit = 1u << (scancode % 32);
+			if (event.key.state == SDL_PRESSED)
+			{
+				input.keys[scancode / 32] |= bit;
+			}
+			else
+			{
+				input.keys[scancode / 32] &= ~bit;
+			}
+		}
+		input.modifiers = event.key.keysym.mod;
+		break;
+	}
+	default:
 		return;
 	}
-	
-	if (_focused)
+
+	++input.sequence;
+}
+
+int Window::GetInputSlot() const
+{
+	return _inputSlot;
+}
+
+// Event pump thread, as events arrive.
+void Window::QueueEvent(QueuedEvent event)
+{
+	if (event.event.type == SDL_WINDOWEVENT && (event.event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED || event.event.window.event == SDL_WINDOWEVENT_MOVED))
 	{
-		int mouseX, mouseY;
-		const unsigned int mouseButtonMask = SDL_GetMouseState(&mouseX, &mouseY);		
-		MouseDelegate(this, mouseX, _height - mouseY, mouseButtonMask);
+		event.offScreen = IsOffScreen();
+		event.refreshRate = QueryRefreshRate();
+#ifndef _WIN32
+		SDL_GetGlobalMouseState(&event.cursorX, &event.cursorY);
+#endif
 	}
-	
-	wglMakeCurrent(_deviceContext, _unityContext);
 
-	glBindVertexArray(_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);	
+	_eventRing.Push(event);
+}
 
-	glUseProgram(_shaderProgram);
-	glBindTexture(GL_TEXTURE_2D, _pTextureHandle);
-	glUniform1i(glGetUniformLocation(_shaderProgram, "tex"), 0);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+// Main thread. Applies everything the pump thread queued for the window since the last call.
+void Window::ProcessEvents()
+{
+	const auto now = std::chrono::steady_clock::now();
+	QueuedEvent queued;
+	while (_eventRing.Pop(queued))
+	{
+		_stats.RecordEventLatency(queued.received, now);
+		if (queued.event.type == SDL_WINDOWEVENT)
+		{
+			HandleEvent(queued);
+		}
+		else
+		{
+			HandleInput(queued.event);
+		}
+	}
+}
 
-	glViewport(0, 0, _width, _height);
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+void Window::SetDirtyTracking(bool enabled)
+{
+	_dirtyTracking = enabled;
+	MarkDirty();
+}
+
+// May be called from any thread, including the render thread through a plugin event.
+void Window::MarkDirty()
+{
+	++_frameVersion;
+}
+
+float Window::GetFirstPresentLatency() const
+{
+	return _firstPresentMilliseconds;
+}
+
+void Window::GetPresentCounters(unsigned int& presented, unsigned int& skipped) const
+{
+	presented = _presentCount;
+	skipped = _skippedPresentCount;
+}
+
+void Window::GetStats(WindowStats& stats) const
+{
+	GetPresentCounters(stats.presented, stats.skipped);
+	stats.deferred = _deferredPresentCount;
+	stats.droppedEvents = _eventRing.GetDropped();
+	_stats.Get(stats);
+}
+
+// Render thread, for draws timed on Unity's context. Presenter threads record their own.
+void Window::RecordGpuTime(float milliseconds)
+{
+	_stats.RecordGpu(milliseconds);
+}
+
+// Called on Unity's render thread before Render or QueuePresent.
+bool Window::ShouldPresent()
+{
+	// Hidden windows and windows the scheduler left out are not skips, the scheduler counts its deferrals itself.
+	if (!_visible || !_presentTicket.exchange(false))
+	{
+		return false;
+	}
+
+	const unsigned int frameVersion = _frameVersion;
+	if (_dirtyTracking && frameVersion == _presentedVersion)
+	{
+		++_skippedPresentCount;
+		return false;
+	}
+
+	_presentedVersion = frameVersion;
+	_textureReadyTime = std::chrono::steady_clock::now();
+	if (_presentCount++ == 0)
+	{
+		_firstPresentMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _createdTime).count();
+	}
+	return true;
+}
+
+// Called on Unity's render thread with Unity's context current.
+void Window::Render(GLStateCache& state, GpuTimer& timer)
+{
+	if (_pWindow == nullptr || _drawable == nullptr)
+	{
+		return;
+	}
+
+	const auto presentStart = std::chrono::steady_clock::now();
+	const int width = _width;
+	const int height = _height;
+	ProfilerScope scope(ProfilerMarkerRender, ID, width, height, _presentPath);
+	const WindowTexture& texture = UpdateTexture(state);
+
+	_pPlatform->MakeUnityContextCurrent(_drawable);
+	const bool timed = timer.Begin(Handle);
+	const PresentPath presentPath = PresentTexture(state, _vao, _readFramebuffer, texture, width, height, UpscaleMode(_upscaleMode.load()));
+	if (timed)
+	{
+		timer.End();
+	}
+	_presentPath = presentPath;
+
+	ProfilerScope swapScope(ProfilerMarkerSwap, ID, width, height, presentPath);
+	const int presentMode = _presentMode;
+	if (presentMode != _renderThreadPresentMode)
+	{
+		const int swapInterval = _pPlatform->SetSwapInterval(_drawable, GetSwapInterval(PresentMode(presentMode), false));
+		_activePresentMode = GetSwapMode(swapInterval, PresentMode(presentMode), false);
+		_renderThreadPresentMode = presentMode;
+	}
+
+	const auto swapStart = std::chrono::steady_clock::now();
+	_pPlatform->SwapBuffers(_drawable);
+	_stats.Record(presentStart, swapStart, _textureReadyTime);
+}
+
+// Called on Unity's render thread with Unity's context current. Falls back to Render if no presenter could be started.
+void Window::QueuePresent(GLStateCache& state, GpuTimer& timer, bool continuous)
+{
+	if (_pWindow == nullptr || _drawable == nullptr)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(_presenterMutex);
+	if (_pPresenter == nullptr && !_presenterFailed)
+	{
+		_pPresenter = new Presenter(*_pPlatform, _drawable, ID, _stats);
+		if (_pPresenter->Start())
+		{
+			_pPresenter->SetRefreshRate(_refreshRate);
+			_pPresenter->SetVisible(_visible);
+		}
+		else
+		{
+			Log("Failed to start a presenter for window '" + _title + "', presenting on the render thread instead.");
+			delete _pPresenter;
+			_pPresenter = nullptr;
+			_presenterFailed = true;
+		}
+	}
+
+	if (_pPresenter == nullptr)
+	{
+		lock.unlock();
+		Render(state, timer);
+		return;
+	}
 
-	SwapBuffers(_deviceContext);
-	glFinish();
+	_pPresenter->QueueFrame(state, UpdateTexture(state), _width, _height, UpscaleMode(_upscaleMode.load()), PresentMode(_presentMode.load()), continuous);
+}
+
+void Window::StopPresenter()
+{
+	std::lock_guard<std::mutex> lock(_presenterMutex);
+	if (_pPresenter == nullptr)
+	{
+		return;
+	}
+
+	// The presenter may have left the drawable on another swap interval.
+	delete _pPresenter;
+	_pPresenter = nullptr;
+	_renderThreadPresentMode = -1;
+}
+
+#ifdef WINDOW_PLUGIN_VULKAN
+// Called on Unity's render thread, outside of queue access. Unity records the texture's transition for the blit.
+bool Window::AccessVulkanTexture(UnityVulkanImage& image)
+{
+	if (_pSwapchain == nullptr)
+	{
+		return false;
+	}
+
+	return _pVulkanDevice->AccessTexture(_pNativeTexture, image);
+}
+
+// Called from Unity's queue access callback with the windows lock held, after Unity submitted the texture's transition.
+void Window::PresentVulkan(const UnityVulkanImage& image)
+{
+	if (_pSwapchain == nullptr)
+	{
+		return;
+	}
+
+	const auto presentStart = std::chrono::steady_clock::now();
+
+	// Same as UpdateTexture, the content can only be smaller than the image Unity reports.
+	const int contentWidth = std::min(int(_contentWidth), int(image.extent.width));
+	const int contentHeight = std::min(int(_contentHeight), int(image.extent.height));
+	ProfilerScope scope(ProfilerMarkerSwap, ID, _width, _height, PresentPathBlit);
+	const auto swapStart = std::chrono::steady_clock::now();
+	_presentPath = _pSwapchain->Present(image, contentWidth, contentHeight, _width, _height, PresentMode(_presentMode.load()), _bufferCount) ? PresentPathBlit : PresentPathNone;
+	_activePresentMode = _pSwapchain->GetPresentMode();
+	_activeBufferCount = _pSwapchain->GetImageCount();
+	_stats.Record(presentStart, swapStart, _textureReadyTime);
+}
+
+#endif
+
+// Called when the window goes away or Unity's Vulkan device shuts down, the surface belongs to its instance.
+void Window::ReleaseVulkan()
+{
+#ifdef WINDOW_PLUGIN_VULKAN
+	if (_pSwapchain != nullptr)
+	{
+		_pVulkanDevice->Retire(_pSwapchain);
+		_pSwapchain = nullptr;
+	}
+#endif
+	_pVulkanDevice = nullptr;
+}
+
+PresentPath Window::GetPresentPath()
+{
+	std::lock_guard<std::mutex> lock(_presenterMutex);
+	if (_pPresenter != nullptr)
+	{
+		return _pPresenter->GetPresentPath();
+	}
+
+	return PresentPath(_presentPath.load());
+}
+
+const WindowTexture& Window::UpdateTexture(GLStateCache& state)
+{
+	const GLuint textureHandle = GLuint(reinterpret_cast<uintptr_t>(_pNativeTexture.load()));
+	if (textureHandle != _texture.handle)
+	{
+		state.BindTexture(textureHandle);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &_texture.width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &_texture.height);
+		_texture.handle = textureHandle;
+	}
+
+	// The content can only be smaller than the texture, unless the handle was swapped in between the two reads.
+	_texture.contentWidth = std::min(int(_contentWidth), _texture.width);
+	_texture.contentHeight = std::min(int(_contentHeight), _texture.height);
+	return _texture;
+}
+
+// Draws the texture into the default framebuffer of whichever drawable is current, using the cheapest path available.
+PresentPath Window::PresentTexture(GLStateCache& state, GLuint vao, GLuint readFramebuffer, const WindowTexture& texture, int width, int height, UpscaleMode upscaleMode)
+{
+	if (texture.width == 0 || texture.height == 0)
+	{
+		return PresentPathNone;
+	}
+
+	state.BindDrawFramebuffer(0);
+	state.DisableCapabilities();
+
+	if (texture.contentWidth == width && texture.contentHeight == height)
+	{
+		state.BindReadFramebuffer(readFramebuffer);
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.handle, 0);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		return PresentPathBlit;
+	}
+
+	state.BindVertexArray(vao);
+	state.UseProgram(_shaderPrograms[upscaleMode]);
+	state.BindTexture(texture.handle);
+	state.BindSampler(_sampler);
+	state.Viewport(width, height);
+	state.TexcoordScale(float(texture.contentWidth) / texture.width, float(texture.contentHeight) / texture.height);
+
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+	GLStateCache::CountDraw();
+	return PresentPathShader;
 }
 
 Window::~Window()
 {
+	StopPresenter();
+	ReleaseVulkan();
+	Inputs.Release(_inputSlot);
+
 	if (_pWindow == nullptr)
 	{
 		return;
 	}
 
-	//Destroy window
-	SDL_DestroyWindow(_pWindow);
+	// The SDL window belongs to the event pump thread, which must also stop routing events to this object.
+	GetEventPump().Invoke([this]
+	{
+		GetEventPump().Unregister(this);
+		if (_drawable != nullptr)
+		{
+			_pPlatform->DestroyDrawable(_drawable);
+			_drawable = nullptr;
+		}
+
+		SDL_DestroyWindow(_pWindow);
+	});
 	_pWindow = nullptr;
 }
\ No newline at end of file
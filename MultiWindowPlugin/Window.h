@@ -3,43 +3,217 @@
 #include <GL/glew.h>
 #include <SDL.h>
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include "UnityInterface.h"
+#include "GLPlatform.h"
+#include "PresentStats.h"
+#include "WindowEvents.h"
+#include "WindowInput.h"
+#include "EventPump.h"
+#include "PresentScheduler.h"
+
+class Presenter;
+class GLStateCache;
+class GpuTimer;
+class VulkanDevice;
+class VulkanSwapchain;
+struct UnityVulkanImage;
+
+// How a window's texture reached its back buffer on the last present.
+enum PresentPath : int
+{
+	PresentPathNone = 0,
+	// Textured quad through the shader, used whenever the texture has to be scaled.
+	PresentPathShader = 1,
+	// glBlitFramebuffer from the texture, used when it matches the window size exactly.
+	PresentPathBlit = 2
+};
+
+// How a texture rendered below window resolution is scaled up to it.
+enum UpscaleMode : int
+{
+	UpscaleBilinear = 0,
+	// Bilinear followed by contrast-adaptive sharpening, which backs off around edges that are already sharp.
+	UpscaleSharpen = 1,
+	UpscaleModeCount
+};
+
+// How a window's swaps are synchronised with its display, mirrored in ExternalWindow.cs.
+enum PresentMode : int
+{
+	// Swaps as soon as the frame is drawn, which can tear.
+	PresentModeImmediate = 0,
+	PresentModeVsync = 1,
+	// Waits for vblank unless the frame is already late, then swaps at once and may tear.
+	PresentModeAdaptive = 2,
+	// Never tears and never holds up Unity: the newest frame replaces any waiting one and is shown at the next vblank.
+	// OpenGL emulates it with a presenter thread swapping on vblank, even while threaded presentation is off.
+	PresentModeMailbox = 3
+};
+
+// A texture handed over by Unity. Pooled textures can be larger than requested, only the bottom-left content rectangle is presented.
+struct WindowTexture
+{
+	GLuint handle;
+	int width;
+	int height;
+	int contentWidth;
+	int contentHeight;
+};
 
 class Window
 {
 public:
-	Window(std::string title, HGLRC unityContext, int width, int height, bool resizable, GLuint textureHandle);
+	// Exactly one of pPlatform and pVulkanDevice is set, depending on the renderer Unity runs on.
+	Window(std::string title, GLPlatform* pPlatform, VulkanDevice* pVulkanDevice, int width, int height, float renderScale, bool resizable, void* nativeTexture);
 	~Window();
 
-	bool CreateContext();
-	void Render();
-	void HandleEvent(const SDL_Event& event);
+	bool CreateContext(SDL_Window* pPooledWindow);
+	bool ShouldPresent();
+	void Render(GLStateCache& state, GpuTimer& timer);
+	void QueuePresent(GLStateCache& state, GpuTimer& timer, bool continuous);
+	void StopPresenter();
+#ifdef WINDOW_PLUGIN_VULKAN
+	bool AccessVulkanTexture(UnityVulkanImage& image);
+	void PresentVulkan(const UnityVulkanImage& image);
+#endif
+	void ReleaseVulkan();
+	int GetInputSlot() const;
+	void UpdateResize(unsigned int debounceMilliseconds);
+	void UpdateVisibility();
+	void SetTargetRate(float rate);
+	bool IsPresentDue(std::chrono::steady_clock::time_point horizon, std::chrono::steady_clock::time_point& due) const;
+	bool IsFocused() const;
+	float GetPresentCost() const;
+	void SetSchedule(PresentSchedule schedule, std::chrono::steady_clock::time_point now);
+	PresentSchedule GetSchedule() const;
+	void QueueEvent(QueuedEvent event);
+	void ProcessEvents();
+	void Expose(const SDL_Event& event);
 	void SetPosition(int x, int y) const;
 	void Drag() const;
+	void SetDirtyTracking(bool enabled);
+	void MarkDirty();
+	void SetRenderScale(float renderScale);
+	void SetTexture(void* nativeTexture, int contentWidth, int contentHeight);
+	void SetUpscaleMode(UpscaleMode mode);
+	void SetPresentMode(PresentMode mode, int bufferCount);
+	PresentMode GetRequestedPresentMode() const;
+	void GetPresentMode(PresentMode& mode, int& bufferCount);
+	void GetPresentCounters(unsigned int& presented, unsigned int& skipped) const;
+	PresentPath GetPresentPath();
+	float GetFirstPresentLatency() const;
+	void GetStats(WindowStats& stats) const;
+	void RecordGpuTime(float milliseconds);
 
-	static CloseFunction CloseDelegate;
-	static ResizeFunction ResizeDelegate;
-	static MouseUpdateFuncton MouseDelegate;
-	static MoveFunction MoveDelegate;
+	static WindowEventQueue Events;
+	static WindowInputTable Inputs;
 	static void LoadResources();
 	static void UnloadResources();
+	static GLuint CreateVertexArray();
+	static PresentPath PresentTexture(GLStateCache& state, GLuint vao, GLuint readFramebuffer, const WindowTexture& texture, int width, int height, UpscaleMode upscaleMode);
+	static float ClampRenderScale(float renderScale);
+	static int GetSwapInterval(PresentMode mode, bool presenterThread);
+	static PresentMode GetSwapMode(int swapInterval, PresentMode requested, bool presenterThread);
 
 	unsigned int ID;
+	// Set once the window is registered, what managed code refers to it by.
+	WindowHandle Handle;
 
 private:
 	SDL_Window* _pWindow;
-	HGLRC _unityContext;
-	HDC _deviceContext;
-	GLuint _pTextureHandle;
+	GLPlatform* _pPlatform;
+	PlatformDrawable _drawable;
+	VulkanDevice* _pVulkanDevice;
+	VulkanSwapchain* _pSwapchain;
 	std::string _title;
-	int _width;
-	int _height;
+
+	// Written on the main thread by SetTexture, read on the render thread by Render.
+	// A GL texture name on OpenGL, a pointer to the VkImage on Vulkan, as returned by Texture.GetNativeTexturePtr.
+	std::atomic<void*> _pNativeTexture;
+	std::atomic<int> _contentWidth;
+	std::atomic<int> _contentHeight;
+	std::atomic<int> _width;
+	std::atomic<int> _height;
+	std::atomic<float> _renderScale;
+	std::atomic<int> _upscaleMode;
+	std::atomic<int> _presentMode;
+	std::atomic<int> _bufferCount;
+	// What presents on the render thread or through Vulkan actually got, a presenter reports its own.
+	std::atomic<int> _activePresentMode;
+	std::atomic<int> _activeBufferCount;
+	// Render thread only, the mode the drawable's swap interval was last set for on Unity's context.
+	int _renderThreadPresentMode;
+
 	bool _resizable;
-	bool _focused;
+	// The HWND on Windows, polled for compositor cloaking.
+	void* _pNativeWindow;
+	// Main thread only. Points into Inputs, or at _unmappedInput once all of its slots are taken.
+	int _inputSlot;
+	WindowInputState* _pInput;
+	WindowInputState _unmappedInput;
+	// Filled by the event pump thread, drained by ProcessEvents.
+	EventRing _eventRing;
+	// Main thread only. Size changes are applied once per frame at most, after the size has settled for the debounce period.
+	bool _resizePending;
+	Uint32 _resizeTicks;
+	// Main thread only, a mask of HiddenReason. Hidden windows are neither presented nor rendered by Unity.
+	unsigned int _hiddenReasons;
+	std::atomic<bool> _visible;
+	// Main thread only. Zero presents whenever Unity renders a frame, otherwise the period of the window's target rate.
+	std::chrono::steady_clock::duration _presentInterval;
+	std::chrono::steady_clock::time_point _nextPresentTime;
+	std::chrono::steady_clock::time_point _lastScheduledTime;
+	PresentSchedule _schedule;
+	// Set by the scheduler on the main thread, taken by the next ShouldPresent on the render thread.
+	std::atomic<bool> _presentTicket;
+	// Created and destroyed on the render thread, but also reached from the event pump thread's event watch.
+	std::mutex _presenterMutex;
+	Presenter* _pPresenter;
+	bool _presenterFailed;
+	std::atomic<int> _refreshRate;
+
+	// With dirty tracking enabled, a window is only presented when its frame version has moved on since the last present.
+	std::atomic<bool> _dirtyTracking;
+	std::atomic<unsigned int> _frameVersion;
+	unsigned int _presentedVersion;
+	std::atomic<unsigned int> _presentCount;
+	// Only presents left out because the frame had not changed.
+	std::atomic<unsigned int> _skippedPresentCount;
+	std::atomic<unsigned int> _deferredPresentCount;
+
+	// Time from construction to the first present, the latency a user sees when undocking. Negative until presented.
+	const std::chrono::steady_clock::time_point _createdTime;
+	std::atomic<float> _firstPresentMilliseconds;
+
+	// Render thread only, when ShouldPresent last let a frame through. Unity has finished rendering the texture by then.
+	std::chrono::steady_clock::time_point _textureReadyTime;
+	PresentStats _stats;
+
+	// Render thread only, its size is queried whenever the texture handle changes.
+	WindowTexture _texture;
+	std::atomic<int> _presentPath;
+
+	void HandleEvent(const QueuedEvent& queued);
+	void HandleInput(const SDL_Event& event);
+	void UpdateRefreshRate(int refreshRate);
+	int QueryRefreshRate() const;
+	bool IsOffScreen() const;
+	void ResizeTexture();
+	const WindowTexture& UpdateTexture(GLStateCache& state);
+	static int ScaledSize(int size, float renderScale);
+
+	static const GLuint PositionAttribute = 0;
+	static const GLuint TexcoordAttribute = 1;
 
 	static GLuint _vao;
 	static GLuint _vbo;
 	static GLuint _ebo;
-	static GLuint _fragmentShader;
+	static GLuint _fragmentShaders[UpscaleModeCount];
 	static GLuint _vertexShader;
-	static GLuint _shaderProgram;
+	static GLuint _shaderPrograms[UpscaleModeCount];
+	static GLuint _sampler;
+	static GLuint _readFramebuffer;
 };
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "WindowEvents.h"
+#include <algorithm>
+
+void WindowEventQueue::Push(WindowHandle window, WindowEventType type, int x, int y, unsigned int flags)
+{
+	if (type == WindowEventResize)
+	{
+		for (WindowEvent& event : _events)
+		{
+			if (event.window == window && event.type == type)
+			{
+				event.x = x;
+				event.y = y;
+				event.flags = flags;
+				return;
+			}
+		}
+	}
+
+	WindowEvent event;
+	event.window = window;
+	event.type = type;
+	event.x = x;
+	event.y = y;
+	event.flags = flags;
+	_events.push_back(event);
+}
+
+int WindowEventQueue::Drain(WindowEvent* events, int capacity)
+{
+	const int count = std::min(std::max(capacity, 0), int(_events.size()));
+	std::copy(_events.begin(), _events.begin() + count, events);
+	_events.erase(_events.begin(), _events.begin() + count);
+	return count;
+}
+
+void WindowEventQueue::Remove(WindowHandle window)
+{
+	_events.erase(std::remove_if(_events.begin(), _events.end(), [window](const WindowEvent& event) { return event.window == window; }), _events.end());
+}
+
+void WindowEventQueue::Clear()
+{
+	_events.clear();
+}
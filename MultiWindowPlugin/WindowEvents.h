@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include "WindowRegistry.h"
+
+// Mirrored in WindowManager.cs.
+enum WindowEventType : int
+{
+	// The user asked to close the window.
+	WindowEventClose = 0,
+	// x and y are the texture size the window now wants, answered with SetWindowTexture.
+	WindowEventResize = 1,
+	// x and y are the cursor in screen coordinates, flags is 1 if the cursor is over Unity's window.
+	WindowEventMove = 2,
+	// flags is 1 if the window can be seen again, 0 once it is minimised, hidden, off every display or cloaked.
+	WindowEventVisibility = 3
+};
+
+// Blittable, mirrored in WindowManager.cs.
+struct WindowEvent
+{
+	WindowHandle window;
+	int type;
+	int x;
+	int y;
+	unsigned int flags;
+};
+
+// Events raised while pumping, handed to managed code in one batch by UpdateWindows rather than one reverse P/Invoke each.
+// Main thread only. A resize event replaces an undelivered one of the same window, only the latest state matters.
+class WindowEventQueue
+{
+public:
+	void Push(WindowHandle window, WindowEventType type, int x, int y, unsigned int flags);
+	// Moves up to capacity events into events and returns how many. The rest are delivered by the next call.
+	int Drain(WindowEvent* events, int capacity);
+	// Called when a window is disposed, its undelivered events would refer to a deleted window.
+	void Remove(WindowHandle window);
+	void Clear();
+
+private:
+	std::vector<WindowEvent> _events;
+};
@@ -0,0 +1,57 @@
+#include "WindowInput.h"
+#include <algorithm>
+
+WindowInputTable::WindowInputTable()
+	: _states()
+	, _used()
+{
+}
+
+int WindowInputTable::Allocate()
+{
+	bool* pFree = std::find(_used, _used + Capacity, false);
+	if (pFree == _used + Capacity)
+	{
+		return -1;
+	}
+
+	*pFree = true;
+	const int slot = int(pFree - _used);
+	// Keep the sequence moving so a reader holding an old value of a reused slot still sees a change.
+	const unsigned int sequence = _states[slot].sequence + 1;
+	_states[slot] = WindowInputState();
+	_states[slot].sequence = sequence;
+	return slot;
+}
+
+void WindowInputTable::Release(int slot)
+{
+	if (slot >= 0 && slot < Capacity)
+	{
+		_used[slot] = false;
+	}
+}
+
+WindowInputState* WindowInputTable::Get(int slot)
+{
+	return slot >= 0 && slot < Capacity && _used[slot] ? &_states[slot] : nullptr;
+}
+
+WindowInputState* WindowInputTable::Data()
+{
+	return _states;
+}
+
+void WindowInputTable::BeginFrame()
+{
+	for (int i = 0; i < Capacity; ++i)
+	{
+		WindowInputState& state = _states[i];
+		if (_used[i] && (state.wheelX != 0 || state.wheelY != 0))
+		{
+			state.wheelX = 0;
+			state.wheelY = 0;
+			++state.sequence;
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// SDL_NUM_SCANCODES bits.
+static const int InputKeyWords = 512 / 32;
+
+// Blittable, mirrored in ExternalWindow.cs, which reads it in place rather than receiving a callback per change.
+// Written on the main thread by UpdateWindows, so managed code always sees a whole frame's state.
+struct WindowInputState
+{
+	// Incremented whenever any other field changes.
+	unsigned int sequence;
+	int focused;
+	// Texture pixels from the bottom left, which is what Unity's cameras and canvases see.
+	int cursorX;
+	int cursorY;
+	// SDL button mask.
+	unsigned int buttons;
+	// Wheel steps received during the last UpdateWindows.
+	int wheelX;
+	int wheelY;
+	// SDL_Keymod.
+	unsigned int modifiers;
+	// One bit per held SDL scancode.
+	unsigned int keys[InputKeyWords];
+};
+
+// Fixed array of input states, never reallocated so managed code can map it once through GetWindowInputStates.
+class WindowInputTable
+{
+public:
+	static const int Capacity = 64;
+
+	WindowInputTable();
+	// Returns a cleared slot, or -1 when all of them are taken.
+	int Allocate();
+	void Release(int slot);
+	WindowInputState* Get(int slot);
+	WindowInputState* Data();
+	// Clears the previous frame's wheel steps, called before pumping.
+	void BeginFrame();
+
+private:
+	WindowInputState _states[Capacity];
+	bool _used[Capacity];
+};
@@ -0,0 +1,88 @@
+#include "WindowPool.h"
+#include <algorithm>
+
+WindowPool::WindowPool()
+	: _capacity(0)
+	, _graphicsFlag(SDL_WINDOW_OPENGL)
+	, _pooledGraphicsFlag(SDL_WINDOW_OPENGL)
+	, _stats()
+{
+}
+
+void WindowPool::SetCapacity(int capacity)
+{
+	_capacity = std::min(std::max(capacity, 0), MaxCapacity);
+	while (int(_windows.size()) > _capacity)
+	{
+		SDL_DestroyWindow(_windows.back());
+		_windows.pop_back();
+	}
+}
+
+void WindowPool::SetGraphicsFlag(Uint32 flag)
+{
+	_graphicsFlag = flag;
+}
+
+SDL_Window* WindowPool::Take()
+{
+	if (_windows.empty() || _pooledGraphicsFlag != _graphicsFlag)
+	{
+		return nullptr;
+	}
+
+	SDL_Window* pWindow = _windows.back();
+	_windows.pop_back();
+	return pWindow;
+}
+
+void WindowPool::Refill()
+{
+	const Uint32 graphicsFlag = _graphicsFlag;
+	if (graphicsFlag != _pooledGraphicsFlag)
+	{
+		Clear();
+		_pooledGraphicsFlag = graphicsFlag;
+	}
+
+	if (int(_windows.size()) >= _capacity)
+	{
+		return;
+	}
+
+	// Resizable so any request can be served, Window::CreateContext turns it off again if needed.
+	SDL_Window* pWindow = SDL_CreateWindow("", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, graphicsFlag | SDL_WINDOW_HIDDEN | SDL_WINDOW_RESIZABLE);
+	if (pWindow != nullptr)
+	{
+		_windows.push_back(pWindow);
+	}
+}
+
+void WindowPool::Clear()
+{
+	for (auto it = _windows.begin(); it != _windows.end(); ++it)
+	{
+		SDL_DestroyWindow(*it);
+	}
+	_windows.clear();
+}
+
+void WindowPool::RecordCreation(bool pooled, float milliseconds)
+{
+	if (pooled)
+	{
+		++_stats.pooledCreations;
+	}
+	else
+	{
+		++_stats.coldCreations;
+	}
+
+	_stats.lastCreateMilliseconds = milliseconds;
+	_stats.maxCreateMilliseconds = std::max(_stats.maxCreateMilliseconds, milliseconds);
+}
+
+void WindowPool::GetStats(WindowCreationStats& stats) const
+{
+	stats = _stats;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+#include <atomic>
+
+// Blittable, mirrored in WindowManager.cs.
+struct WindowCreationStats
+{
+	unsigned int pooledCreations;
+	unsigned int coldCreations;
+	// Time CreateNewWindow blocked the main thread for, in milliseconds.
+	float lastCreateMilliseconds;
+	float maxCreateMilliseconds;
+};
+
+// Hidden windows created ahead of time, so opening a window does not pay for SDL_CreateWindow and pixel format
+// selection while the user is dragging. Event pump thread only, SDL windows belong to the thread that pumps their
+// messages. RecordCreation and GetStats are called on the main thread.
+class WindowPool
+{
+public:
+	WindowPool();
+
+	void SetCapacity(int capacity);
+	// SDL_WINDOW_OPENGL or SDL_WINDOW_VULKAN, may be called from the render thread when the graphics device is created.
+	// Windows pooled with the other flag are replaced on the next refill.
+	void SetGraphicsFlag(Uint32 flag);
+	// Returns nullptr when the pool is empty.
+	SDL_Window* Take();
+	// Creates at most one window per call, so refilling is spread over several frames.
+	void Refill();
+	void Clear();
+
+	void RecordCreation(bool pooled, float milliseconds);
+	void GetStats(WindowCreationStats& stats) const;
+
+	static const int MaxCapacity = 8;
+
+private:
+	std::vector<SDL_Window*> _windows;
+	int _capacity;
+	std::atomic<Uint32> _graphicsFlag;
+	// The flag the windows in the pool were created with.
+	Uint32 _pooledGraphicsFlag;
+	WindowCreationStats _stats;
+};
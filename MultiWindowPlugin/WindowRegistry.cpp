@@ -0,0 +1,107 @@
+#include "WindowRegistry.h"
+
+static unsigned int SlotIndex(WindowHandle handle)
+{
+	return static_cast<unsigned int>(handle & 0xFFFFFFFFu);
+}
+
+static unsigned int Generation(WindowHandle handle)
+{
+	return static_cast<unsigned int>(handle >> 32);
+}
+
+WindowHandle WindowRegistry::Add(Window* pWindow)
+{
+	unsigned int slotIndex;
+	if (_freeSlots.empty())
+	{
+		slotIndex = static_cast<unsigned int>(_slots.size());
+		Slot slot;
+		slot.generation = 1;
+		slot.dense = 0;
+		_slots.push_back(slot);
+	}
+	else
+	{
+		slotIndex = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+
+	Slot& slot = _slots[slotIndex];
+	slot.dense = static_cast<unsigned int>(_dense.size());
+	_dense.push_back(pWindow);
+	_denseSlots.push_back(slotIndex);
+	return (WindowHandle(slot.generation) << 32) | slotIndex;
+}
+
+Window* WindowRegistry::Remove(WindowHandle handle)
+{
+	Window* pWindow = Get(handle);
+	if (pWindow == nullptr)
+	{
+		return nullptr;
+	}
+
+	Slot& slot = _slots[SlotIndex(handle)];
+	const unsigned int lastSlot = _denseSlots.back();
+	_dense[slot.dense] = _dense.back();
+	_denseSlots[slot.dense] = lastSlot;
+	_slots[lastSlot].dense = slot.dense;
+	_dense.pop_back();
+	_denseSlots.pop_back();
+
+	Retire(slot);
+	_freeSlots.push_back(SlotIndex(handle));
+	return pWindow;
+}
+
+Window* WindowRegistry::Get(WindowHandle handle) const
+{
+	const unsigned int slotIndex = SlotIndex(handle);
+	if (slotIndex >= _slots.size())
+	{
+		return nullptr;
+	}
+
+	// A free slot's generation has not been handed out yet, so only live windows match.
+	const Slot& slot = _slots[slotIndex];
+	return slot.generation == Generation(handle) ? _dense[slot.dense] : nullptr;
+}
+
+void WindowRegistry::Clear()
+{
+	for (auto it = _denseSlots.begin(); it != _denseSlots.end(); ++it)
+	{
+		Retire(_slots[*it]);
+		_freeSlots.push_back(*it);
+	}
+
+	_dense.clear();
+	_denseSlots.clear();
+}
+
+void WindowRegistry::Retire(Slot& slot)
+{
+	// Zero would make the slot's next handle look like an invalid one.
+	slot.generation = slot.generation == 0xFFFFFFFFu ? 1 : slot.generation + 1;
+}
+
+std::vector<Window*>::const_iterator WindowRegistry::begin() const
+{
+	return _dense.begin();
+}
+
+std::vector<Window*>::const_iterator WindowRegistry::end() const
+{
+	return _dense.end();
+}
+
+int WindowRegistry::Count() const
+{
+	return int(_dense.size());
+}
+
+Window* WindowRegistry::operator[](int index) const
+{
+	return _dense[index];
+}
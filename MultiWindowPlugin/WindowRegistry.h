@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+class Window;
+
+// What managed code holds instead of a Window pointer: the registry slot in the low 32 bits and the slot's generation
+// in the high 32 bits. Zero is never a valid handle.
+typedef unsigned long long WindowHandle;
+
+// Slot map of the live windows. Handles resolve in constant time and stop resolving once their window is removed,
+// even after the slot has been reused. Windows are kept densely packed for iteration, in no particular order.
+// Modified on the main thread under _windowsMutex, which the render thread holds while it reads.
+class WindowRegistry
+{
+public:
+	WindowHandle Add(Window* pWindow);
+	// Returns the window the handle referred to, nullptr if it was already stale.
+	Window* Remove(WindowHandle handle);
+	// nullptr for stale handles and zero.
+	Window* Get(WindowHandle handle) const;
+	void Clear();
+
+	std::vector<Window*>::const_iterator begin() const;
+	std::vector<Window*>::const_iterator end() const;
+	int Count() const;
+	Window* operator[](int index) const;
+
+private:
+	struct Slot
+	{
+		unsigned int generation;
+		// Index into _dense while the slot is in use.
+		unsigned int dense;
+	};
+
+	static void Retire(Slot& slot);
+
+	std::vector<Slot> _slots;
+	std::vector<unsigned int> _freeSlots;
+	std::vector<Window*> _dense;
+	// The slot of each entry in _dense, so the last entry can be moved into a removed one's place.
+	std::vector<unsigned int> _denseSlots;
+};
@@ -0,0 +1,123 @@
+// Unity Native Plugin API copyright © 2015 Unity Technologies ApS
+//
+// Licensed under the Unity Companion License for Unity - dependent projects--see[Unity Companion License](http://www.unity3d.com/legal/licenses/Unity_Companion_License).
+//
+// Unless expressly provided otherwise, the Software under this license is made available strictly on an “AS IS” BASIS WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED.Please review the license for details on these and other terms and conditions.
+
+#pragma once
+#include "IUnityInterface.h"
+#include "IUnityProfilerCallbacks.h"
+
+#include <stddef.h>
+
+// Unity Profiler Native plugin API provides an ability to emit profiler markers from native plugins.
+// Marker, category and metadata types are shared with IUnityProfilerCallbacks.h.
+//
+//  Usage example:
+//
+//  #include <IUnityInterface.h>
+//  #include <IUnityProfiler.h>
+//
+//  static IUnityProfiler* s_UnityProfiler = NULL;
+//  static const UnityProfilerMarkerDesc* s_MyPluginMarker = NULL;
+//
+//  extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API UnityPluginLoad(IUnityInterfaces* unityInterfaces)
+//  {
+//      s_UnityProfiler = unityInterfaces->Get<IUnityProfiler>();
+//      s_UnityProfiler->CreateMarker(&s_MyPluginMarker, "MyPluginMethod", kUnityProfilerCategoryOther, kUnityProfilerMarkerFlagDefault, 0);
+//  }
+//
+//  static void MyPluginMethod()
+//  {
+//      UnityProfilerBeginSample(s_UnityProfiler, s_MyPluginMarker);
+//      // Code which I want to see in Unity Profiler as "MyPluginMethod".
+//      UnityProfilerEndSample(s_UnityProfiler, s_MyPluginMarker);
+//  }
+
+enum UnityBuiltinProfilerCategory_
+{
+    kUnityProfilerCategoryRender = 0,
+    kUnityProfilerCategoryScripts = 1,
+    kUnityProfilerCategoryManagedJobs = 2,
+    kUnityProfilerCategoryBurstJobs = 3,
+    kUnityProfilerCategoryGUI = 4,
+    kUnityProfilerCategoryPhysics = 5,
+    kUnityProfilerCategoryAnimation = 6,
+    kUnityProfilerCategoryAi = 7,
+    kUnityProfilerCategoryAudio = 8,
+    kUnityProfilerCategoryAudioJob = 9,
+    kUnityProfilerCategoryAudioUpdateJob = 10,
+    kUnityProfilerCategoryVideo = 11,
+    kUnityProfilerCategoryParticles = 12,
+    kUnityProfilerCategoryGi = 13,
+    kUnityProfilerCategoryNetwork = 14,
+    kUnityProfilerCategoryLoading = 15,
+    kUnityProfilerCategoryOther = 16,
+    kUnityProfilerCategoryGC = 17,
+    kUnityProfilerCategoryVSync = 18,
+    kUnityProfilerCategoryOverhead = 19,
+    kUnityProfilerCategoryPlayerLoop = 20,
+    kUnityProfilerCategoryDirector = 21,
+    kUnityProfilerCategoryVR = 22,
+    kUnityProfilerCategoryAllocation = 23,
+    kUnityProfilerCategoryInternal = 24,
+    kUnityProfilerCategoryFileIO = 25,
+    kUnityProfilerCategoryUISystemLayout = 26,
+    kUnityProfilerCategoryUISystemRender = 27,
+    kUnityProfilerCategoryVFX = 28,
+    kUnityProfilerCategoryBuildInterface = 29,
+    kUnityProfilerCategoryInput = 30,
+    kUnityProfilerCategoryVirtualTexturing = 31
+};
+
+enum UnityProfilerMarkerDataUnit_
+{
+    kUnityProfilerMarkerDataUnitUndefined = 0,
+    kUnityProfilerMarkerDataUnitTimeNanoseconds = 1,
+    kUnityProfilerMarkerDataUnitBytes = 2,
+    kUnityProfilerMarkerDataUnitCount = 3,
+    kUnityProfilerMarkerDataUnitPercent = 4,
+    kUnityProfilerMarkerDataUnitFrequencyHz = 5,
+};
+typedef uint8_t UnityProfilerMarkerDataUnit;
+
+// Available since 2020.1
+UNITY_DECLARE_INTERFACE(IUnityProfiler)
+{
+    // Emit a begin, end or single event for a marker, with optional metadata matching the marker's metadata descriptions.
+    void(UNITY_INTERFACE_API * EmitEvent)(const UnityProfilerMarkerDesc * markerDesc, UnityProfilerMarkerEventType eventType, uint16_t eventDataCount, const UnityProfilerMarkerData * eventData);
+
+    // Returns 1 if the profiler is capturing, 0 otherwise. Emitting events while it is not capturing is a no-op.
+    int(UNITY_INTERFACE_API * IsEnabled)();
+
+    // Returns 1 if the profiler is available in this build (Editor and Development Players), 0 otherwise.
+    int(UNITY_INTERFACE_API * IsAvailable)();
+
+    // Create a new marker, or return an existing one with the same name.
+    // Returns 0 on success and non-zero in case of error.
+    // \param desc receives the marker description, which stays valid for the lifetime of the process.
+    // \param eventDataCount is the number of metadata entries the marker's begin events carry.
+    int(UNITY_INTERFACE_API * CreateMarker)(const UnityProfilerMarkerDesc** desc, const char* name, UnityProfilerCategoryId category, UnityProfilerMarkerFlags flags, int eventDataCount);
+
+    // Name a marker's metadata entry, so the Profiler can show it.
+    // Returns 0 on success and non-zero in case of error.
+    int(UNITY_INTERFACE_API * SetMarkerMetadataName)(const UnityProfilerMarkerDesc * desc, int index, const char* metadataName, UnityProfilerMarkerDataType metadataType, UnityProfilerMarkerDataUnit metadataUnit);
+
+    // Register the calling thread with the profiler, so markers emitted on it are captured.
+    // Returns 0 on success and non-zero in case of error.
+    int(UNITY_INTERFACE_API * RegisterThread)(UnityProfilerThreadId * threadId, const char* groupName, const char* name);
+    int(UNITY_INTERFACE_API * UnregisterThread)(UnityProfilerThreadId threadId);
+};
+UNITY_REGISTER_INTERFACE_GUID(0x2CE79ED8316A4833ULL, 0x87076B2013E1571FULL, IUnityProfiler)
+
+#ifdef __cplusplus
+inline void UnityProfilerBeginSample(IUnityProfiler* profiler, const UnityProfilerMarkerDesc* markerDesc)
+{
+    profiler->EmitEvent(markerDesc, kUnityProfilerMarkerEventTypeBegin, 0, NULL);
+}
+
+inline void UnityProfilerEndSample(IUnityProfiler* profiler, const UnityProfilerMarkerDesc* markerDesc)
+{
+    profiler->EmitEvent(markerDesc, kUnityProfilerMarkerEventTypeEnd, 0, NULL);
+}
+#endif
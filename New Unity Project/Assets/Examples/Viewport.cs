@@ -10,6 +10,7 @@ public class Viewport : MonoBehaviour
     private GameObject _gameObject;
     private ExternalWindow _window;
     private Rect _startRect;
+    private bool _reportUndockLatency;
 
     public bool Docked
     {
@@ -34,10 +35,11 @@ public class Viewport : MonoBehaviour
     {
         _camera.rect = new Rect(0f, 0f, 1f, 1f);
         _window = WindowManager.Instance.CreateWindow("Window", 1024, 768, false);
-        _camera.targetTexture = _window.RenderTexture;
+        _window.Camera = _camera;
         _window.OnClose += OnWindowClosed;
         _window.OnMoved += OnWindowMoved;
         _window.Drag();
+        _reportUndockLatency = true;
     }
 
     public bool CursorInViewport()
@@ -63,6 +65,16 @@ public class Viewport : MonoBehaviour
         _transform.LookAt(Vector3.zero);
     }
 
+    [UsedImplicitly]
+    private void Update()
+    {
+        if (_reportUndockLatency && _window != null && _window.FirstPresentLatency >= 0f)
+        {
+            Debug.Log(string.Format("Undocked in {0:F1} ms.", _window.FirstPresentLatency));
+            _reportUndockLatency = false;
+        }
+    }
+
     private void OnWindowClosed(object sender, EventArgs args)
     {
         _camera.rect = _startRect;
@@ -1,7 +1,8 @@
-﻿using System;
+using System;
 using System.Collections.Generic;
 using System.Runtime.InteropServices;
 using UnityEngine;
+using UnityEngine.Rendering;
 using Object = UnityEngine.Object;
 
 [Flags]
@@ -13,64 +14,433 @@ public enum WindowMouseButton
     Right = 4
 }
 
+// Matches PresentPath in Window.h.
+public enum WindowPresentPath
+{
+    None = 0,
+    Shader = 1,
+    Blit = 2
+}
+
+// Matches UpscaleMode in Window.h.
+public enum WindowUpscaleMode
+{
+    Bilinear = 0,
+    Sharpen = 1
+}
+
+// Matches PresentMode in Window.h.
+public enum WindowPresentMode
+{
+    Immediate = 0,
+    Vsync = 1,
+    Adaptive = 2,
+    Mailbox = 3
+}
+
+// Matches PresentSchedule in PresentScheduler.h.
+public enum WindowPresentSchedule
+{
+    Scheduled = 0,
+    NotDue = 1,
+    Deferred = 2
+}
+
+// Matches WindowInputState in WindowInput.h. Only its layout is used, the plugin's copy is read in place.
+[StructLayout(LayoutKind.Sequential)]
+internal struct WindowInputState
+{
+    public uint Sequence;
+    public int Focused;
+    public int CursorX;
+    public int CursorY;
+    public uint Buttons;
+    public int WheelX;
+    public int WheelY;
+    public uint Modifiers;
+    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 16)]
+    public uint[] Keys;
+}
+
 public delegate void WindowMovedHandler(int mouseX, int mouseY, bool cursorInUnityWindow);
+public delegate void WindowVisibilityHandler(bool visible);
 
 public class ExternalWindow : IDisposable
 {
     [DllImport("UnityWindowPlugin")]
-    private static extern void DisposeWindow(IntPtr windowHandle);
+    private static extern void DisposeWindow(ulong windowHandle);
     
     [DllImport("UnityWindowPlugin")]
-    private static extern void SetWindowPosition(IntPtr windowHandle, int x, int y);
+    private static extern void SetWindowPosition(ulong windowHandle, int x, int y);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void DragWindow(ulong windowHandle);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetWindowDirtyTracking(ulong windowHandle, bool enabled);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void MarkWindowDirty(ulong windowHandle);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void GetWindowPresentCounters(ulong windowHandle, out uint presented, out uint skipped);
 
     [DllImport("UnityWindowPlugin")]
-    private static extern void DragWindow(IntPtr windowHandle);
+    private static extern int GetWindowPresentPath(ulong windowHandle);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetWindowPresentMode(ulong windowHandle, WindowPresentMode mode, int bufferCount);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void GetWindowPresentMode(ulong windowHandle, out WindowPresentMode mode, out int bufferCount);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern float GetWindowFirstPresentLatency(ulong windowHandle);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetWindowRenderScale(ulong windowHandle, float renderScale);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetWindowUpscaleMode(ulong windowHandle, WindowUpscaleMode mode);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetWindowTargetRate(ulong windowHandle, float rate);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern WindowPresentSchedule GetWindowPresentSchedule(ulong windowHandle);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetWindowTexture(ulong windowHandle, IntPtr texturePtr, int contentWidth, int contentHeight);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern IntPtr GetWindowInputStates(out int capacity);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern int GetWindowInputSlot(ulong windowHandle);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern IntPtr GetRenderEventAndDataFunc();
+
+    // Matches RenderEvent in UnityInterface.h.
+    private const int MarkWindowDirtyEvent = 2;
 
-    private IntPtr _windowHandle;
+    private static readonly int InputStateSize = Marshal.SizeOf(typeof(WindowInputState));
+    private static readonly int SequenceOffset = Marshal.OffsetOf(typeof(WindowInputState), "Sequence").ToInt32();
+    private static readonly int FocusedOffset = Marshal.OffsetOf(typeof(WindowInputState), "Focused").ToInt32();
+    private static readonly int CursorXOffset = Marshal.OffsetOf(typeof(WindowInputState), "CursorX").ToInt32();
+    private static readonly int CursorYOffset = Marshal.OffsetOf(typeof(WindowInputState), "CursorY").ToInt32();
+    private static readonly int ButtonsOffset = Marshal.OffsetOf(typeof(WindowInputState), "Buttons").ToInt32();
+    private static readonly int WheelXOffset = Marshal.OffsetOf(typeof(WindowInputState), "WheelX").ToInt32();
+    private static readonly int WheelYOffset = Marshal.OffsetOf(typeof(WindowInputState), "WheelY").ToInt32();
+    private static readonly int ModifiersOffset = Marshal.OffsetOf(typeof(WindowInputState), "Modifiers").ToInt32();
+    private static readonly int KeysOffset = Marshal.OffsetOf(typeof(WindowInputState), "Keys").ToInt32();
+
+    // The plugin's input state array, which stays at the same address while it is loaded.
+    private static IntPtr _inputStates;
+
+    private ulong _windowHandle;
+    // This window's entry in _inputStates, zero if the plugin ran out of slots.
+    private IntPtr _inputState;
+    private readonly RenderTexturePool _texturePool;
+    private Camera _camera;
+    // Set while the camera is disabled because the window is hidden or not presenting, so a camera the user disabled
+    // stays disabled.
+    private bool _cameraSuspended;
+    private bool _throttleCamera;
+    private float _targetRate;
+    private bool _dirtyTracking;
+    private float _renderScale;
+    private WindowUpscaleMode _upscaleMode;
+    private WindowPresentMode _presentMode;
+    private int _bufferCount;
     private readonly HashSet<Canvas> _canvases;
 
     public event EventHandler OnClose;
     public event WindowMovedHandler OnMoved;
+    public event WindowVisibilityHandler OnVisibilityChanged;
 
+    /// <summary>
+    /// Pooled texture the window presents. It can be larger than the window, only the bottom-left <see cref="PixelRect"/> is shown.
+    /// </summary>
     public RenderTexture RenderTexture { get; private set; }
-    public Vector2 MousePosition { get; set; }
-    public WindowMouseButton MouseButton { get; set; }
+    public int ContentWidth { get; private set; }
+    public int ContentHeight { get; private set; }
+
+    /// <summary>
+    /// False while the window is minimised, hidden, off every display or cloaked by the compositor. The plugin does not
+    /// present hidden windows and <see cref="Camera"/> is disabled until the window can be seen again.
+    /// </summary>
+    public bool Visible { get; private set; }
+
+    /// <summary>
+    /// Whether the plugin presents the window this frame, decided by <see cref="TargetRate"/> and
+    /// <see cref="WindowManager.PresentBudgetMicroseconds"/> when the frame's windows are updated.
+    /// </summary>
+    public WindowPresentSchedule PresentSchedule { get; private set; }
+
+    /// <summary>
+    /// Incremented by the plugin whenever any of the input state below changes.
+    /// </summary>
+    public uint InputSequence
+    {
+        get { return (uint)ReadInput(SequenceOffset); }
+    }
+
+    public bool Focused
+    {
+        get { return ReadInput(FocusedOffset) != 0; }
+    }
 
-    internal ExternalWindow(IntPtr windowHandle, RenderTexture renderTexture)
+    /// <summary>
+    /// Cursor in texture pixels from the bottom left.
+    /// </summary>
+    public Vector2 MousePosition
+    {
+        get { return new Vector2(ReadInput(CursorXOffset), ReadInput(CursorYOffset)); }
+    }
+
+    public WindowMouseButton MouseButton
+    {
+        get { return (WindowMouseButton)ReadInput(ButtonsOffset); }
+    }
+
+    /// <summary>
+    /// Wheel steps received this frame.
+    /// </summary>
+    public Vector2 MouseScrollDelta
+    {
+        get { return new Vector2(ReadInput(WheelXOffset), ReadInput(WheelYOffset)); }
+    }
+
+    /// <summary>
+    /// Held modifier keys as an SDL_Keymod mask.
+    /// </summary>
+    public uint KeyModifiers
+    {
+        get { return (uint)ReadInput(ModifiersOffset); }
+    }
+
+    internal ExternalWindow(ulong windowHandle, RenderTexturePool texturePool, RenderTexture renderTexture, int contentWidth, int contentHeight, float renderScale)
     {
         _windowHandle = windowHandle;
+        _texturePool = texturePool;
         RenderTexture = renderTexture;
+        ContentWidth = contentWidth;
+        ContentHeight = contentHeight;
+        _renderScale = renderScale;
         _canvases = new HashSet<Canvas>();
+        Visible = true;
+        _presentMode = WindowPresentMode.Vsync;
+        _throttleCamera = true;
+
+        if (_inputStates == IntPtr.Zero)
+        {
+            int capacity;
+            _inputStates = GetWindowInputStates(out capacity);
+        }
+
+        int inputSlot = GetWindowInputSlot(windowHandle);
+        if (inputSlot >= 0)
+        {
+            _inputState = new IntPtr(_inputStates.ToInt64() + inputSlot * InputStateSize);
+        }
     }
 
-    internal IntPtr Resize(int width, int height)
+    /// <summary>
+    /// Whether the key with the given SDL scancode is held while the window has focus.
+    /// </summary>
+    public bool IsKeyDown(int scancode)
     {
-        if (RenderTexture.width == width && RenderTexture.height == height)
+        if (scancode < 0 || scancode >= 16 * 32)
         {
-            return RenderTexture.GetNativeDepthBufferPtr();
+            return false;
+        }
+
+        return (ReadInput(KeysOffset + scancode / 32 * 4) & (1 << (scancode % 32))) != 0;
+    }
+
+    private int ReadInput(int offset)
+    {
+        return _inputState == IntPtr.Zero ? 0 : Marshal.ReadInt32(_inputState, offset);
+    }
+
+    public Rect PixelRect
+    {
+        get { return new Rect(0, 0, ContentWidth, ContentHeight); }
+    }
+
+    /// <summary>
+    /// The camera rendering into this window. It follows the window's texture and content size across resizes.
+    /// </summary>
+    public Camera Camera
+    {
+        get { return _camera; }
+        set
+        {
+            _camera = value;
+            if (_camera != null)
+            {
+                _camera.targetTexture = RenderTexture;
+                _camera.pixelRect = PixelRect;
+            }
+        }
+    }
+
+    // Answers the plugin's resize event, raised at most once per frame after the window size has settled.
+    internal void Resize(int width, int height)
+    {
+        ContentWidth = width;
+        ContentHeight = height;
+
+        FindCamera();
+
+        if (!RenderTexturePool.FitsBucket(RenderTexture, width, height))
+        {
+            _texturePool.Release(RenderTexture);
+            RenderTexture = _texturePool.Acquire(width, height);
+        }
+
+        Camera = _camera;
+        SetWindowTexture(_windowHandle, RenderTexture.GetNativeTexturePtr(), width, height);
+    }
+
+    // Picks up a camera that was pointed at the texture directly rather than through the Camera property.
+    private void FindCamera()
+    {
+        if (_camera != null)
+        {
+            return;
         }
 
-        Camera targetCamera = null;
         Camera[] cameras = Object.FindObjectsOfType<Camera>();
         for (int i = 0; i < cameras.Length; ++i)
         {
-            Camera cam = cameras[i];
-            if (cam.targetTexture == RenderTexture)
+            if (cameras[i].targetTexture == RenderTexture)
             {
-                targetCamera = cam;
+                _camera = cameras[i];
                 break;
             }
         }
+    }
+
+    // Must match Window::ClampRenderScale and Window::ResizeTexture.
+    internal static float ClampRenderScale(float renderScale)
+    {
+        return Mathf.Clamp(renderScale, 0.25f, 1.0f);
+    }
+
+    internal static int ScaledSize(int size, float renderScale)
+    {
+        return Math.Max(1, (int)Math.Round(size * renderScale, MidpointRounding.AwayFromZero));
+    }
+
+    /// <summary>
+    /// Fraction of the window's resolution that <see cref="RenderTexture"/> is allocated at, between 0.25 and 1.
+    /// The plugin upscales to the window when presenting, using <see cref="UpscaleMode"/>. Changing it reallocates the texture.
+    /// </summary>
+    public float RenderScale
+    {
+        get { return _renderScale; }
+        set
+        {
+            _renderScale = ClampRenderScale(value);
+            SetWindowRenderScale(_windowHandle, _renderScale);
+        }
+    }
+
+    public WindowUpscaleMode UpscaleMode
+    {
+        get { return _upscaleMode; }
+        set
+        {
+            _upscaleMode = value;
+            SetWindowUpscaleMode(_windowHandle, value);
+        }
+    }
+
+    /// <summary>
+    /// How the window's swaps wait for its display. Mailbox never tears and never holds up Unity's render thread; on
+    /// OpenGL it starts a presenter thread for the window even while threaded presentation is off. Modes the driver
+    /// does not support fall back, see <see cref="ActivePresentMode"/>.
+    /// </summary>
+    public WindowPresentMode PresentMode
+    {
+        get { return _presentMode; }
+        set
+        {
+            _presentMode = value;
+            SetWindowPresentMode(_windowHandle, _presentMode, _bufferCount);
+        }
+    }
+
+    /// <summary>
+    /// Number of swapchain images to ask for, e.g. 3 for triple buffering. Zero leaves it to the driver. Vulkan only,
+    /// OpenGL windows are always double-buffered.
+    /// </summary>
+    public int BufferCount
+    {
+        get { return _bufferCount; }
+        set
+        {
+            _bufferCount = Mathf.Max(value, 0);
+            SetWindowPresentMode(_windowHandle, _presentMode, _bufferCount);
+        }
+    }
+
+    /// <summary>
+    /// The mode the window actually presents with, once the plugin has applied <see cref="PresentMode"/>.
+    /// </summary>
+    public WindowPresentMode ActivePresentMode
+    {
+        get
+        {
+            WindowPresentMode mode;
+            int bufferCount;
+            GetWindowPresentMode(_windowHandle, out mode, out bufferCount);
+            return mode;
+        }
+    }
+
+    /// <summary>
+    /// The number of swapchain images the window actually presents with, zero until a Vulkan window first presents.
+    /// </summary>
+    public int ActiveBufferCount
+    {
+        get
+        {
+            WindowPresentMode mode;
+            int bufferCount;
+            GetWindowPresentMode(_windowHandle, out mode, out bufferCount);
+            return bufferCount;
+        }
+    }
 
-        Object.Destroy(RenderTexture);
-        RenderTexture = new RenderTexture(width, height, 0, RenderTextureFormat.ARGB32);
-        
-        if (targetCamera != null)
+    /// <summary>
+    /// Presents at most this many times a second, e.g. 10 for a minimap next to a 60 Hz viewport. Windows sharing a rate
+    /// present in different frames. Zero presents every frame Unity renders.
+    /// </summary>
+    public float TargetRate
+    {
+        get { return _targetRate; }
+        set
         {
-            targetCamera.targetTexture = RenderTexture;
+            _targetRate = Mathf.Max(value, 0.0f);
+            SetWindowTargetRate(_windowHandle, _targetRate);
         }
+    }
 
-        return RenderTexture.GetNativeTexturePtr();
+    /// <summary>
+    /// When enabled, <see cref="Camera"/> only renders in frames the window is presented in, so a throttled or deferred
+    /// window costs neither a present nor a camera render.
+    /// </summary>
+    public bool ThrottleCamera
+    {
+        get { return _throttleCamera; }
+        set
+        {
+            _throttleCamera = value;
+            UpdateCamera();
+        }
     }
 
     public void AssociateCanvas(Canvas canvas)
@@ -98,6 +468,59 @@ public class ExternalWindow : IDisposable
         DragWindow(_windowHandle);
     }
 
+    /// <summary>
+    /// When enabled, the window is only presented after <see cref="MarkDirty()"/> has been called (or it was resized or exposed),
+    /// instead of every frame.
+    /// </summary>
+    public bool DirtyTracking
+    {
+        get { return _dirtyTracking; }
+        set
+        {
+            _dirtyTracking = value;
+            SetWindowDirtyTracking(_windowHandle, value);
+        }
+    }
+
+    public void MarkDirty()
+    {
+        MarkWindowDirty(_windowHandle);
+    }
+
+    /// <summary>
+    /// Marks the window as changed when <paramref name="commandBuffer"/> executes, e.g. from a camera's
+    /// <see cref="CameraEvent.AfterEverything"/> so the window presents exactly when its camera has rendered.
+    /// </summary>
+    public void MarkDirty(CommandBuffer commandBuffer)
+    {
+        commandBuffer.IssuePluginEventAndData(GetRenderEventAndDataFunc(), MarkWindowDirtyEvent, new IntPtr((long)_windowHandle));
+    }
+
+    public void GetPresentCounters(out uint presented, out uint skipped)
+    {
+        GetWindowPresentCounters(_windowHandle, out presented, out skipped);
+    }
+
+    // The path taken by the last present, a blit when the texture matches the window size exactly.
+    public WindowPresentPath PresentPath
+    {
+        get { return (WindowPresentPath)GetWindowPresentPath(_windowHandle); }
+    }
+
+    /// <summary>
+    /// Milliseconds from the window being requested to its first present, or a negative value until it has been presented.
+    /// </summary>
+    public float FirstPresentLatency
+    {
+        get { return GetWindowFirstPresentLatency(_windowHandle); }
+    }
+
+    // The native window handle, as reported in WindowStats.Window. Handles of disposed windows are never reused.
+    public ulong Handle
+    {
+        get { return _windowHandle; }
+    }
+
     internal void Moved(int mouseX, int mouseY, bool cursorInUnityWindow)
     {
         if (OnMoved != null)
@@ -106,6 +529,43 @@ public class ExternalWindow : IDisposable
         }
     }
 
+    internal void VisibilityChanged(bool visible)
+    {
+        Visible = visible;
+        FindCamera();
+        UpdateCamera();
+
+        if (OnVisibilityChanged != null)
+        {
+            OnVisibilityChanged(visible);
+        }
+    }
+
+    // Called once per frame after the plugin has scheduled the frame's presents.
+    internal void UpdateSchedule()
+    {
+        PresentSchedule = GetWindowPresentSchedule(_windowHandle);
+        UpdateCamera();
+    }
+
+    private void UpdateCamera()
+    {
+        bool render = Visible && (!_throttleCamera || PresentSchedule == WindowPresentSchedule.Scheduled);
+        if (!render && _camera != null && _camera.enabled)
+        {
+            _camera.enabled = false;
+            _cameraSuspended = true;
+        }
+        else if (render && _cameraSuspended)
+        {
+            if (_camera != null)
+            {
+                _camera.enabled = true;
+            }
+            _cameraSuspended = false;
+        }
+    }
+
     public void Dispose()
     {
         if (OnClose != null)
@@ -115,14 +575,15 @@ public class ExternalWindow : IDisposable
 
         if (RenderTexture != null)
         {
-            Object.Destroy(RenderTexture);
+            _texturePool.Release(RenderTexture);
             RenderTexture = null;
         }
 
-        if (_windowHandle != IntPtr.Zero)
+        if (_windowHandle != 0)
         {
             DisposeWindow(_windowHandle);
-            _windowHandle = IntPtr.Zero;
+            _windowHandle = 0;
+            _inputState = IntPtr.Zero;
         }
     }
 }
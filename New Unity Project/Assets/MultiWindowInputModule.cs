@@ -737,7 +737,7 @@ public class MultiWindowInputModule : PointerInputModule
         Vector2 pos = screenSpaceCursorPosition;
         leftData.delta = pos - leftData.position;
         leftData.position = pos;
-        leftData.scrollDelta = Input.mouseScrollDelta;
+        leftData.scrollDelta = ActiveWindow == null ? Input.mouseScrollDelta : ActiveWindow.MouseScrollDelta;
         leftData.button = PointerEventData.InputButton.Left;
         eventSystem.RaycastAll(leftData, m_RaycastResultCache);
         RaycastResult raycast = FindFirstRaycast(m_RaycastResultCache);
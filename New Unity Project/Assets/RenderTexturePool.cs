@@ -0,0 +1,105 @@
+﻿using System;
+using System.Collections.Generic;
+using UnityEngine;
+using Object = UnityEngine.Object;
+
+/// <summary>
+/// Recycles window render textures so resizing and undocking do not allocate on every size change.
+/// Sizes are rounded up to <see cref="BucketSize"/> pixels, so a texture is usually larger than requested and only its
+/// bottom-left corner is rendered to and presented. Released textures are kept until the pool exceeds its memory budget,
+/// at which point the least recently released ones are destroyed.
+/// </summary>
+public class RenderTexturePool : IDisposable
+{
+    public const int BucketSize = 64;
+
+    // Least recently released first.
+    private readonly LinkedList<RenderTexture> _released = new LinkedList<RenderTexture>();
+    private long _allocatedBytes;
+
+    public RenderTexturePool(long memoryBudgetBytes)
+    {
+        MemoryBudgetBytes = memoryBudgetBytes;
+    }
+
+    /// <summary>
+    /// Upper bound for textures allocated by the pool, both in use and released. Textures in use are never evicted,
+    /// so the pool can exceed it while every window holds a texture.
+    /// </summary>
+    public long MemoryBudgetBytes { get; set; }
+
+    public long AllocatedBytes
+    {
+        get { return _allocatedBytes; }
+    }
+
+    public RenderTexture Acquire(int width, int height)
+    {
+        int bucketWidth = Bucket(width);
+        int bucketHeight = Bucket(height);
+
+        for (LinkedListNode<RenderTexture> node = _released.Last; node != null; node = node.Previous)
+        {
+            RenderTexture released = node.Value;
+            if (released.width == bucketWidth && released.height == bucketHeight)
+            {
+                _released.Remove(node);
+                return released;
+            }
+        }
+
+        RenderTexture texture = new RenderTexture(bucketWidth, bucketHeight, 0, RenderTextureFormat.ARGB32);
+        texture.Create();
+        _allocatedBytes += SizeInBytes(texture);
+        Trim();
+        return texture;
+    }
+
+    public void Release(RenderTexture texture)
+    {
+        if (texture == null)
+        {
+            return;
+        }
+
+        _released.AddLast(texture);
+        Trim();
+    }
+
+    public static bool FitsBucket(RenderTexture texture, int width, int height)
+    {
+        return texture != null && texture.width == Bucket(width) && texture.height == Bucket(height);
+    }
+
+    public void Dispose()
+    {
+        foreach (RenderTexture texture in _released)
+        {
+            Object.Destroy(texture);
+        }
+        _released.Clear();
+        _allocatedBytes = 0;
+    }
+
+    private void Trim()
+    {
+        while (_allocatedBytes > MemoryBudgetBytes && _released.Count > 0)
+        {
+            RenderTexture evicted = _released.First.Value;
+            _released.RemoveFirst();
+            _allocatedBytes -= SizeInBytes(evicted);
+            Object.Destroy(evicted);
+        }
+    }
+
+    private static int Bucket(int size)
+    {
+        return (Math.Max(size, 1) + BucketSize - 1) / BucketSize * BucketSize;
+    }
+
+    private static long SizeInBytes(RenderTexture texture)
+    {
+        // ARGB32 without a depth buffer.
+        return (long)texture.width * texture.height * 4;
+    }
+}
@@ -1,46 +1,223 @@
 ﻿using System;
+using System.Collections;
 using System.Collections.Generic;
 using System.Linq;
 using System.Runtime.InteropServices;
 using JetBrains.Annotations;
 using UnityEngine;
 
+// Matches FramePacingMode in FramePacer.h.
+public enum FramePacingMode
+{
+    Finish = 0,
+    Fence = 1,
+    FenceSkip = 2
+}
+
+// Matches GLStateCounters in GLStateCache.h.
+[StructLayout(LayoutKind.Sequential)]
+public struct GLStateCounters
+{
+    public uint ElidedBinds;
+    public uint AvoidedUniformLookups;
+    public uint AvoidedTexParameters;
+}
+
+// Matches WindowCreationStats in WindowPool.h.
+[StructLayout(LayoutKind.Sequential)]
+public struct WindowCreationStats
+{
+    public uint PooledCreations;
+    public uint ColdCreations;
+    public float LastCreateMilliseconds;
+    public float MaxCreateMilliseconds;
+}
+
+// Matches FrameTimeStats in PresentStats.h. Milliseconds over the last 120 presents of a window.
+[StructLayout(LayoutKind.Sequential)]
+public struct FrameTimeStats
+{
+    public float Last;
+    public float P50;
+    public float P95;
+    public float P99;
+}
+
+// Matches WindowStats in PresentStats.h.
+[StructLayout(LayoutKind.Sequential)]
+public struct WindowStats
+{
+    public ulong Window;
+    public uint Presented;
+    public uint Skipped;
+    public uint Deferred;
+    public FrameTimeStats PresentCpu;
+    public FrameTimeStats Swap;
+    public FrameTimeStats TextureToSwap;
+    public FrameTimeStats Gpu;
+    public FrameTimeStats EventLatency;
+    public uint DroppedEvents;
+}
+
+// Matches DiagnosticsLevel in GLDiagnostics.h, the lowest severity of GL message reported.
+public enum DiagnosticsLevel
+{
+    Off = 0,
+    High = 1,
+    Medium = 2,
+    Low = 3,
+    All = 4
+}
+
+// Matches DiagnosticMessage in GLDiagnostics.h.
+[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+public struct DiagnosticMessage
+{
+    public uint Id;
+    public uint Source;
+    public uint Type;
+    public uint Severity;
+    public uint Count;
+    [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 244)]
+    public string Text;
+}
+
+// Matches WindowEventType in WindowEvents.h.
+public enum WindowEventType
+{
+    Close = 0,
+    Resize = 1,
+    Move = 2,
+    Visibility = 3
+}
+
+// Matches WindowEvent in WindowEvents.h.
+[StructLayout(LayoutKind.Sequential)]
+public struct WindowEvent
+{
+    public ulong Window;
+    public WindowEventType Type;
+    public int X;
+    public int Y;
+    public uint Flags;
+}
+
 public class WindowManager : MonoBehaviour
 {
     [DllImport("UnityWindowPlugin")]
-    private static extern void InitPlugin(
-        [MarshalAs(UnmanagedType.FunctionPtr)] MessageDelegate messageCallback,
-        [MarshalAs(UnmanagedType.FunctionPtr)] CloseDelegate closeCallback,
-        [MarshalAs(UnmanagedType.FunctionPtr)] ResizeDelegate resizeCallback,
-        [MarshalAs(UnmanagedType.FunctionPtr)] MouseUpdateDelegate mouseCallback,
-        [MarshalAs(UnmanagedType.FunctionPtr)] MoveDelegate moveCallback);
+    private static extern void InitPlugin([MarshalAs(UnmanagedType.FunctionPtr)] MessageDelegate messageCallback);
     
     [DllImport("UnityWindowPlugin")]
     private static extern void ShutdownPlugin();
 
     [DllImport("UnityWindowPlugin")]
-    private static extern IntPtr CreateNewWindow(string title, int width, int height, bool resizeable, IntPtr texturePtr);
+    private static extern ulong CreateNewWindow(string title, int width, int height, float renderScale, bool resizeable, IntPtr texturePtr);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetWindowPoolSize(int size);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void GetWindowCreationStats(out WindowCreationStats stats);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern int UpdateWindows([Out] WindowEvent[] events, int capacity);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern IntPtr GetRenderEventFunc();
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetFramePacing(FramePacingMode mode, int framesInFlight);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetThreadedPresentation(bool enabled);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetContinuousPresentation(bool enabled);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetResizeDebounce(int milliseconds);
 
     [DllImport("UnityWindowPlugin")]
-    private static extern void UpdateWindows();
+    private static extern void SetPresentBudget(int microseconds);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetGpuTiming(bool enabled);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetTraceRecording(bool enabled);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetDiagnosticsLevel(DiagnosticsLevel level);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern int PollDiagnostics([Out] DiagnosticMessage[] messages, int capacity, out uint dropped);
+
+    [DllImport("UnityWindowPlugin")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    private static extern bool DumpTrace(string path);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void SetTraceSpikeDump(string directory, float thresholdMilliseconds);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern void GetGLStateCounters(out GLStateCounters counters);
+
+    [DllImport("UnityWindowPlugin")]
+    private static extern int GetWindowStats([Out] WindowStats[] stats, int capacity);
+
+    // Matches GL_DEBUG_SEVERITY_HIGH and GL_DEBUG_SEVERITY_MEDIUM.
+    private const uint DebugSeverityHigh = 0x9146;
+    private const uint DebugSeverityMedium = 0x9147;
+
+    // Matches RenderEvent in UnityInterface.h.
+    private const int PresentWindowsEvent = 1;
     
     [UnmanagedFunctionPointer(CallingConvention.StdCall)]
     private delegate void MessageDelegate(string message);
 
-    [UnmanagedFunctionPointer(CallingConvention.StdCall)]
-    private delegate void CloseDelegate(IntPtr window);
-    
-    [UnmanagedFunctionPointer(CallingConvention.StdCall)]
-    private delegate IntPtr ResizeDelegate(IntPtr window, int width, int height);
+    private static Dictionary<ulong, ExternalWindow> _windows;
+    // Filled by UpdateWindows once per frame, events that do not fit are delivered the next frame.
+    private static readonly WindowEvent[] _events = new WindowEvent[64];
+    private static RenderTexturePool _texturePool;
 
-    [UnmanagedFunctionPointer(CallingConvention.StdCall)]
-    private delegate void MouseUpdateDelegate(IntPtr window, int mouseX, int mouseY, uint mouseButtonMask);
+    [SerializeField]
+    private FramePacingMode _framePacingMode = FramePacingMode.Fence;
 
-    [UnmanagedFunctionPointer(CallingConvention.StdCall)]
-    private delegate void MoveDelegate(IntPtr window, int mouseX, int mouseY, bool cursorInUnityWindow);
+    [SerializeField]
+    private int _framesInFlight = 2;
+
+    [SerializeField]
+    private bool _threadedPresentation;
+
+    [SerializeField]
+    private bool _continuousPresentation;
+
+    [SerializeField]
+    private int _resizeDebounceMilliseconds = 50;
+
+    [SerializeField]
+    private int _presentBudgetMicroseconds;
+
+    [SerializeField]
+    private bool _gpuTiming;
+
+    [SerializeField]
+    private bool _traceRecording;
+
+    [SerializeField]
+    private DiagnosticsLevel _diagnosticsLevel = DiagnosticsLevel.Off;
+
+    private readonly DiagnosticMessage[] _diagnosticMessages = new DiagnosticMessage[32];
+
+    // Frames longer than this dump the trace into Application.persistentDataPath, zero disables spike dumps.
+    [SerializeField]
+    private float _traceSpikeThresholdMilliseconds;
 
-    private static Dictionary<long, ExternalWindow> _windows;
-    private static ExternalWindow _focusedWindow;
+    [SerializeField]
+    private int _texturePoolBudgetMegabytes = 256;
+
+    [SerializeField]
+    private int _windowPoolSize = 1;
     
     public ExternalWindow[] GetAllWindows()
     {
@@ -53,119 +230,328 @@ public class WindowManager : MonoBehaviour
     private void Awake()
     {
         Instance = this;
-        _windows = new Dictionary<long, ExternalWindow>();
-        InitPlugin(MessageCallback, CloseCallback, ResizeCallback, MouseUpdateCallback, MoveCallback);
+        _windows = new Dictionary<ulong, ExternalWindow>();
+        _texturePool = new RenderTexturePool(_texturePoolBudgetMegabytes * 1024L * 1024L);
+        InitPlugin(MessageCallback);
+        SetFramePacing(_framePacingMode, _framesInFlight);
+        SetThreadedPresentation(_threadedPresentation);
+        SetContinuousPresentation(_continuousPresentation);
+        SetResizeDebounce(_resizeDebounceMilliseconds);
+        SetPresentBudget(_presentBudgetMicroseconds);
+        SetGpuTiming(_gpuTiming);
+        SetTraceRecording(_traceRecording);
+        SetDiagnosticsLevel(_diagnosticsLevel);
+        SetTraceSpikeDump(Application.persistentDataPath, _traceSpikeThresholdMilliseconds);
+        SetWindowPoolSize(_windowPoolSize);
+        StartCoroutine(PresentWindows());
     }
-    
-    public ExternalWindow CreateWindow(string title, int width, int height, bool resizable)
+
+    /// <summary>
+    /// Controls how far the GPU may fall behind window presentation. Fence modes allow up to
+    /// <paramref name="framesInFlight"/> frames (1-4) to be queued before the render thread waits or skips a present.
+    /// </summary>
+    public void ConfigureFramePacing(FramePacingMode mode, int framesInFlight)
     {
-        RenderTexture texture = new RenderTexture(width, height, 0, RenderTextureFormat.ARGB32);
-        texture.Create();
-        IntPtr texturePtr = texture.GetNativeTexturePtr();
+        _framePacingMode = mode;
+        _framesInFlight = framesInFlight;
+        SetFramePacing(mode, framesInFlight);
+    }
 
-        IntPtr windowHandle = CreateNewWindow(title, width, height, resizable, texturePtr);
-        if (windowHandle == IntPtr.Zero)
+    /// <summary>
+    /// When enabled, each window is presented on its own thread through a GL context shared with Unity's,
+    /// so a slow swap on one monitor does not hold up the other windows or the render thread.
+    /// </summary>
+    public bool ThreadedPresentation
+    {
+        get { return _threadedPresentation; }
+        set
         {
-            Debug.LogError("Failed to create new window.");
-            return null;
+            _threadedPresentation = value;
+            SetThreadedPresentation(value);
         }
+    }
 
-        ExternalWindow window = new ExternalWindow(windowHandle, texture);
-        long windowAddress = windowHandle.ToInt64();
+    /// <summary>
+    /// When enabled together with <see cref="ThreadedPresentation"/>, each window keeps presenting its last completed frame
+    /// at its display's refresh rate and redraws immediately when exposed, independent of Unity's frame rate.
+    /// </summary>
+    public bool ContinuousPresentation
+    {
+        get { return _continuousPresentation; }
+        set
+        {
+            _continuousPresentation = value;
+            SetContinuousPresentation(value);
+        }
+    }
 
-        // In rare cases a duplicate window can be produced (despite all happening on the same thread), this catches it.
-        ExternalWindow existing;
-        if (_windows.TryGetValue(windowAddress, out existing))
+    /// <summary>
+    /// How long a window's size must stay unchanged before its texture is reallocated. Until then the old texture is
+    /// presented stretched, so a live resize does not reallocate on every step.
+    /// </summary>
+    public int ResizeDebounceMilliseconds
+    {
+        get { return _resizeDebounceMilliseconds; }
+        set
         {
-            existing.Dispose();
-            _windows[windowAddress] = window;
+            _resizeDebounceMilliseconds = value;
+            SetResizeDebounce(value);
         }
-        else
+    }
+
+    /// <summary>
+    /// Caps the estimated present cost of the windows presented in one frame. Windows that would exceed it are deferred,
+    /// the focused window first in line and then whichever has waited longest, and counted in
+    /// <see cref="WindowStats.Deferred"/>. Estimates include GPU time only while <see cref="GpuTiming"/> is enabled.
+    /// Zero presents every due window.
+    /// </summary>
+    public int PresentBudgetMicroseconds
+    {
+        get { return _presentBudgetMicroseconds; }
+        set
         {
-            _windows.Add(windowAddress, window);
+            _presentBudgetMicroseconds = value;
+            SetPresentBudget(value);
         }
-        return window;
     }
 
-    [UsedImplicitly]
-    private void Update()
+    /// <summary>
+    /// When enabled, the GPU time of each window's draw is measured with timer queries and reported in
+    /// <see cref="WindowStats.Gpu"/>. Results are read back a few frames late so they never stall; OpenGL only.
+    /// </summary>
+    public bool GpuTiming
     {
-        _focusedWindow = null;
-        
-        UpdateWindows();
+        get { return _gpuTiming; }
+        set
+        {
+            _gpuTiming = value;
+            SetGpuTiming(value);
+        }
+    }
 
-        MultiWindowInputModule.Instance.ActiveWindow = _focusedWindow;
+    /// <summary>
+    /// When enabled, event pumping, window creation and disposal, resizes, renders and swaps are recorded into a fixed
+    /// ring of the most recent 65536 events, with the thread each ran on. Costs one atomic load per scope when disabled.
+    /// </summary>
+    public bool TraceRecording
+    {
+        get { return _traceRecording; }
+        set
+        {
+            _traceRecording = value;
+            SetTraceRecording(value);
+        }
     }
 
-    [UsedImplicitly]
-    private void OnDestroy()
+    /// <summary>
+    /// GL messages at or above this severity are captured on Unity's and the presenters' contexts through KHR_debug and
+    /// logged once per frame. Repeats are folded together and rate limited. Off costs nothing, no glGetError is ever called.
+    /// </summary>
+    public DiagnosticsLevel DiagnosticsLevel
     {
-        Instance = null;
-        foreach(ExternalWindow window in _windows.Values)
+        get { return _diagnosticsLevel; }
+        set
         {
-            window.Dispose();
+            _diagnosticsLevel = value;
+            SetDiagnosticsLevel(value);
         }
-        _windows.Clear();
+    }
 
-        ShutdownPlugin();
+    /// <summary>
+    /// Writes the recorded timeline to <paramref name="path"/> as Chrome trace JSON, for chrome://tracing or Perfetto.
+    /// </summary>
+    public bool SaveTrace(string path)
+    {
+        return DumpTrace(path);
     }
-    
-    private static IntPtr ResizeCallback(IntPtr windowHandle, int width, int height)
+
+    /// <summary>
+    /// While <see cref="TraceRecording"/> is enabled, any frame longer than <paramref name="thresholdMilliseconds"/> dumps the
+    /// timeline into <paramref name="directory"/> from a background thread. Zero disables spike dumps.
+    /// </summary>
+    public void ConfigureTraceSpikeDump(string directory, float thresholdMilliseconds)
     {
-        ExternalWindow window;
-        if (!_windows.TryGetValue(windowHandle.ToInt64(), out window))
+        _traceSpikeThresholdMilliseconds = thresholdMilliseconds;
+        SetTraceSpikeDump(directory, thresholdMilliseconds);
+    }
+
+    /// <summary>
+    /// Number of hidden windows (0-8) the plugin keeps ready, so <see cref="CreateWindow"/> only has to show one.
+    /// The pool is refilled one window per frame.
+    /// </summary>
+    public int WindowPoolSize
+    {
+        get { return _windowPoolSize; }
+        set
         {
-            Debug.LogError("Received a window resize callback, but no matching window could be found.");
-            return IntPtr.Zero;
+            _windowPoolSize = value;
+            SetWindowPoolSize(value);
         }
+    }
 
-        return window.Resize(width, height);
+    public WindowCreationStats GetWindowCreationStats()
+    {
+        WindowCreationStats stats;
+        GetWindowCreationStats(out stats);
+        return stats;
     }
 
-    private static void MouseUpdateCallback(IntPtr windowHandle, int mouseX, int mouseY, uint mouseButtonMask)
+    public RenderTexturePool TexturePool
     {
-        ExternalWindow window;
-        if (!_windows.TryGetValue(windowHandle.ToInt64(), out window))
+        get { return _texturePool; }
+    }
+
+    private static IEnumerator PresentWindows()
+    {
+        WaitForEndOfFrame endOfFrame = new WaitForEndOfFrame();
+        IntPtr renderEventFunc = GetRenderEventFunc();
+        while (true)
         {
-            Debug.LogError("Received a window mouse callback, but no matching window could be found.");
-            return;
+            // Present on Unity's render thread once all cameras have rendered into the window textures.
+            yield return endOfFrame;
+            GL.IssuePluginEvent(renderEventFunc, PresentWindowsEvent);
+        }
+    }
+    
+    /// <summary>
+    /// Cumulative count of GL calls the plugin's present path has avoided through its state cache.
+    /// </summary>
+    public GLStateCounters GetGLStateCounters()
+    {
+        GLStateCounters counters;
+        GetGLStateCounters(out counters);
+        return counters;
+    }
+
+    /// <summary>
+    /// Fills <paramref name="stats"/> with the present timings of every open window, without allocating, so it can be
+    /// polled every frame by an overlay. Returns the number of windows, which is larger than the array if it was too short.
+    /// <see cref="WindowStats.Window"/> matches <see cref="ExternalWindow.Handle"/>.
+    /// </summary>
+    public int GetWindowStats(WindowStats[] stats)
+    {
+        return GetWindowStats(stats, stats.Length);
+    }
+
+    /// <summary>
+    /// Opens a window of <paramref name="width"/> by <paramref name="height"/> pixels. Its render texture is allocated at
+    /// that size scaled by <paramref name="renderScale"/>, see <see cref="ExternalWindow.RenderScale"/>.
+    /// </summary>
+    public ExternalWindow CreateWindow(string title, int width, int height, bool resizable, float renderScale = 1.0f)
+    {
+        renderScale = ExternalWindow.ClampRenderScale(renderScale);
+        int contentWidth = ExternalWindow.ScaledSize(width, renderScale);
+        int contentHeight = ExternalWindow.ScaledSize(height, renderScale);
+        RenderTexture texture = _texturePool.Acquire(contentWidth, contentHeight);
+        IntPtr texturePtr = texture.GetNativeTexturePtr();
+
+        ulong windowHandle = CreateNewWindow(title, width, height, renderScale, resizable, texturePtr);
+        if (windowHandle == 0)
+        {
+            Debug.LogError("Failed to create new window.");
+            _texturePool.Release(texture);
+            return null;
         }
 
-        window.MousePosition = new Vector2(mouseX, mouseY);
-        window.MouseButton = (WindowMouseButton)mouseButtonMask;
-        _focusedWindow = window;
+        ExternalWindow window = new ExternalWindow(windowHandle, _texturePool, texture, contentWidth, contentHeight, renderScale);
+        _windows.Add(windowHandle, window);
+        return window;
     }
 
-    private static void CloseCallback(IntPtr windowHandle)
+    [UsedImplicitly]
+    private void Update()
     {
-        ExternalWindow window;
-        long ptrValue = windowHandle.ToInt64();
-        if (!_windows.TryGetValue(ptrValue, out window))
+        int eventCount = UpdateWindows(_events, _events.Length);
+        for (int i = 0; i < eventCount; i++)
         {
-            Debug.LogError("Received a window close callback, but no matching window could be found.");
-            return;
+            HandleEvent(ref _events[i]);
         }
 
-        if (window == _focusedWindow)
+        if (_diagnosticsLevel != DiagnosticsLevel.Off)
         {
-            _focusedWindow = null;
+            LogDiagnostics();
         }
 
-        window.Dispose();
-        _windows.Remove(ptrValue);
+        ExternalWindow focusedWindow = null;
+        foreach (ExternalWindow window in _windows.Values)
+        {
+            window.UpdateSchedule();
+            if (focusedWindow == null && window.Focused)
+            {
+                focusedWindow = window;
+            }
+        }
+
+        MultiWindowInputModule.Instance.ActiveWindow = focusedWindow;
     }
 
-    private static void MoveCallback(IntPtr windowHandle, int mouseX, int mouseY, bool cursorInUnityWindow)
+    [UsedImplicitly]
+    private void OnDestroy()
+    {
+        Instance = null;
+        foreach(ExternalWindow window in _windows.Values)
+        {
+            window.Dispose();
+        }
+        _windows.Clear();
+        _texturePool.Dispose();
+
+        ShutdownPlugin();
+    }
+    
+    private static void HandleEvent(ref WindowEvent windowEvent)
     {
         ExternalWindow window;
-        long ptrValue = windowHandle.ToInt64();
-        if (!_windows.TryGetValue(ptrValue, out window))
+        if (!_windows.TryGetValue(windowEvent.Window, out window))
         {
-            Debug.LogError("Received a window move callback, but no matching window could be found.");
+            // A batch can still carry events for a window disposed earlier in it, or before it was delivered.
             return;
         }
 
-        window.Moved(mouseX, mouseY, cursorInUnityWindow);
+        switch (windowEvent.Type)
+        {
+            case WindowEventType.Close:
+                window.Dispose();
+                _windows.Remove(windowEvent.Window);
+                break;
+            case WindowEventType.Resize:
+                window.Resize(windowEvent.X, windowEvent.Y);
+                break;
+            case WindowEventType.Move:
+                window.Moved(windowEvent.X, windowEvent.Y, windowEvent.Flags != 0);
+                break;
+            case WindowEventType.Visibility:
+                window.VisibilityChanged(windowEvent.Flags != 0);
+                break;
+        }
+    }
+
+    private void LogDiagnostics()
+    {
+        uint dropped;
+        int count = PollDiagnostics(_diagnosticMessages, _diagnosticMessages.Length, out dropped);
+        for (int i = 0; i < count; i++)
+        {
+            DiagnosticMessage message = _diagnosticMessages[i];
+            string text = string.Format("OpenGL 0x{0:X} (x{1}): {2}", message.Id, message.Count, message.Text);
+            if (message.Severity == DebugSeverityHigh)
+            {
+                Debug.LogError(text);
+            }
+            else if (message.Severity == DebugSeverityMedium)
+            {
+                Debug.LogWarning(text);
+            }
+            else
+            {
+                Debug.Log(text);
+            }
+        }
+
+        if (dropped > 0)
+        {
+            Debug.LogWarning(string.Format("{0} OpenGL messages were not logged, they repeated too often or arrived too fast.", dropped));
+        }
     }
 
     private static void MessageCallback(string message)